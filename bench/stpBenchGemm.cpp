@@ -0,0 +1,112 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+/**
+ * @file stpBenchGemm.cpp
+ * @brief Size sweep of the cache-blocked matrix product against the matrix product of the core.
+ */
+
+#include "steppable/mat2d.hpp"
+#include "stpInterp/stpMatrixKernels.hpp"
+#include "stpInterp/stpThreadPool.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace steppable;
+using namespace steppable::parser;
+
+namespace
+{
+    /// The core multiplication is too slow to measure beyond this size.
+    constexpr size_t MAX_CORE_SIZE = 256;
+
+    Matrix randomMatrix(const size_t rows, const size_t cols, std::mt19937& rng, const bool decimals = false)
+    {
+        std::uniform_int_distribution<int> dist(-99, 99); // NOLINT(*-avoid-magic-numbers)
+        std::uniform_int_distribution<int> fraction(10, 99); // NOLINT(*-avoid-magic-numbers)
+        MatVec2D<Number> data(rows, std::vector<Number>(cols));
+        for (auto& row : data)
+            for (auto& value : row)
+            {
+                std::string text = std::to_string(dist(rng));
+                if (decimals)
+                    text += "." + std::to_string(fraction(rng));
+                value = Number(text);
+            }
+        return Matrix(data);
+    }
+
+    double timeMs(const std::function<void()>& fn)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+} // namespace
+
+int main()
+{
+    std::mt19937 rng(42); // NOLINT(*-avoid-magic-numbers)
+    std::printf("Using %zu threads\n", STP_ThreadPool::shared().size());
+    std::printf("%6s %14s %14s %14s %14s %10s\n",
+                "size",
+                "Number (ms)",
+                "kernel (ms)",
+                "decimals (ms)",
+                "dense only (ms)",
+                "GFLOP/s");
+
+    // Decimals are only multiplied with the kernel in fast-math mode, where they may be rounded.
+    STP_KernelContext rounding;
+    rounding.allowRounding = true;
+
+    for (const size_t size : { 64, 128, 256, 512, 1024, 2048, 3000 }) // NOLINT(*-avoid-magic-numbers)
+    {
+        const Matrix lhs = randomMatrix(size, size, rng);
+        const Matrix rhs = randomMatrix(size, size, rng);
+        const Matrix lhsDecimals = randomMatrix(size, size, rng, true);
+        const Matrix rhsDecimals = randomMatrix(size, size, rng, true);
+        const auto lhsDense = STP_toDenseMatrix(lhs);
+        const auto rhsDense = STP_toDenseMatrix(rhs);
+
+        double numberMs = -1.0;
+        if (size <= MAX_CORE_SIZE)
+            numberMs = timeMs([&] { (void)(lhs * rhs); });
+        const double kernelMs = timeMs([&] { (void)STP_applyGemmKernel(lhs, rhs); });
+        const double decimalsMs = timeMs([&] { (void)STP_applyGemmKernel(lhsDecimals, rhsDecimals, rounding); });
+        const double denseMs = timeMs([&] { (void)STP_kernelGemm(*lhsDense, *rhsDense); });
+        const double gflops = 2.0 * static_cast<double>(size * size * size) / (denseMs * 1e6); // NOLINT
+
+        if (numberMs < 0)
+            std::printf("%6zu %14s %14.3f %14.3f %14.3f %10.2f\n", size, "-", kernelMs, decimalsMs, denseMs, gflops);
+        else
+            std::printf(
+                "%6zu %14.3f %14.3f %14.3f %14.3f %10.2f\n", size, numberMs, kernelMs, decimalsMs, denseMs, gflops);
+    }
+    return 0;
+}
@@ -0,0 +1,122 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+/**
+ * @file stpBenchMatrixKernels.cpp
+ * @brief Compare the vectorised matrix kernels against the per-`Number` operators of the core.
+ */
+
+#include "steppable/mat2d.hpp"
+#include "stpInterp/stpMatrixKernels.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace steppable;
+using namespace steppable::parser;
+
+namespace
+{
+    Matrix randomMatrix(const size_t rows, const size_t cols, std::mt19937& rng)
+    {
+        std::uniform_int_distribution<int> dist(1, 999); // NOLINT(*-avoid-magic-numbers)
+        MatVec2D<Number> data(rows, std::vector<Number>(cols));
+        for (auto& row : data)
+            for (auto& value : row)
+                value = Number(std::to_string(dist(rng)));
+        return Matrix(data);
+    }
+
+    double timeMs(const std::function<void()>& fn, const int repeats)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < repeats; i++)
+            fn();
+        const auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count() / repeats;
+    }
+} // namespace
+
+int main()
+{
+    std::mt19937 rng(42); // NOLINT(*-avoid-magic-numbers)
+    std::printf("Kernels use %s\n", STP_kernelIsaName());
+    std::printf(
+        "%6s %4s %14s %14s %14s %14s\n", "size", "op", "Number (ms)", "kernel (ms)", "cached (ms)", "dense only (ms)");
+
+    for (const size_t size : { 32, 64, 128, 256, 512 }) // NOLINT(*-avoid-magic-numbers)
+    {
+        const Matrix lhs = randomMatrix(size, size, rng);
+        const Matrix rhs = randomMatrix(size, size, rng);
+        const auto lhsDense = STP_toDenseMatrix(lhs);
+        const auto rhsDense = STP_toDenseMatrix(rhs);
+        STP_DenseCache lhsCache;
+        STP_DenseCache rhsCache;
+        STP_KernelContext context;
+        context.lhsCache = &lhsCache;
+        context.rhsCache = &rhsCache;
+        std::vector<double> out(size * size);
+        const int repeats = size <= 128 ? 10 : 3; // NOLINT(*-avoid-magic-numbers)
+
+        const std::vector<std::pair<std::string, STP_KernelOp>> ops = {
+            { "+", STP_KernelOp::ADD },
+            { ".*", STP_KernelOp::MUL },
+            { ">", STP_KernelOp::GT },
+        };
+        for (const auto& [opStr, op] : ops)
+        {
+            const double numberMs = timeMs(
+                [&] {
+                    if (opStr == "+")
+                        (void)(lhs + rhs);
+                    else if (opStr == ".*")
+                        (void)lhs.elemWiseMultiply(rhs);
+                    else
+                        (void)(lhs > rhs);
+                },
+                repeats);
+            const double kernelMs = timeMs([&] { (void)STP_applyMatrixKernel(lhs, opStr, rhs); }, repeats);
+            // Operands that are variables keep their dense form, only the result is converted.
+            const double cachedMs = timeMs(
+                [&] { (void)STP_applyMatrixKernel(lhs, opStr, rhs, nullptr, context); }, repeats);
+            const double denseMs = timeMs(
+                [&] {
+                    (void)STP_kernelElementWise(
+                        op, lhsDense->values.data(), rhsDense->values.data(), out.data(), out.size());
+                },
+                repeats);
+
+            std::printf("%6zu %4s %14.3f %14.3f %14.3f %14.3f\n",
+                        size,
+                        opStr.c_str(),
+                        numberMs,
+                        kernelMs,
+                        cachedMs,
+                        denseMs);
+        }
+    }
+    return 0;
+}
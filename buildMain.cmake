@@ -14,6 +14,21 @@ SET(PROJECT_SRC_COMMON
     src/stpExprHandler.cpp
     src/stpInteractive.cpp
     src/stpInterrupt.cpp
+    src/stpFastMath.cpp
+    src/stpOptions.cpp
+    src/stpMatrixKernels.cpp
+    src/stpThreadPool.cpp
+    src/stpFactorial.cpp
+    src/stpOutputSink.cpp
+    src/stpSourceBuffer.cpp
+    src/stpStreaming.cpp
+    src/stpIncrementalParse.cpp
+    src/stpWatch.cpp
+    src/stpBatch.cpp
+    src/stpEvalWorker.cpp
+    src/stpFuture.cpp
+    src/stpServer.cpp
+    src/stpSnapshot.cpp
     # Statement processors
     src/statementProcessors/stpAssignment.cpp
     src/statementProcessors/stpChunkProcessor.cpp
@@ -27,6 +42,8 @@ SET(PROJECT_SRC_COMMON
     src/exprProcessors/stpFnCallExpr.cpp
     src/exprProcessors/stpRangeExpr.cpp
     src/exprProcessors/stpSuffixExpr.cpp
+    src/exprProcessors/stpParallelMap.cpp
+    src/exprProcessors/stpSpawnExpr.cpp
 )
 SET(PROJECT_SRC src/main.cpp ${PROJECT_SRC_COMMON})
 
@@ -48,3 +65,27 @@ INSTALL_TO_BIN(stp_parse)
 ADD_CUSTOM_COMMAND(TARGET stp_parse POST_BUILD
     COMMAND ${CMAKE_COMMAND} -E copy_directory ${CMAKE_CURRENT_SOURCE_DIR}/queries ${CMAKE_BINARY_DIR}/bin/queries
 )
+
+# Embeddable interpreter library with a C API
+OPTION(STP_BUILD_SHARED_INTERP "Build the embeddable interpreter as a shared library" OFF)
+IF(STP_BUILD_SHARED_INTERP)
+    ADD_LIBRARY(stp_interp SHARED ${PROJECT_SRC_COMMON} src/stpCApi.cpp ${TREE_SITTER_SRC})
+ELSE()
+    ADD_LIBRARY(stp_interp STATIC ${PROJECT_SRC_COMMON} src/stpCApi.cpp ${TREE_SITTER_SRC})
+ENDIF()
+TARGET_COMPILE_DEFINITIONS(stp_interp PRIVATE STP_INTERP_BUILD)
+SET_TARGET_PROPERTIES(stp_interp PROPERTIES POSITION_INDEPENDENT_CODE ON)
+TARGET_INCLUDE_DIRECTORIES(stp_interp PUBLIC src/stpInterp PRIVATE ${TREE_SITTER_RUNTIME}/include ${TREE_SITTER_RUNTIME}/src/ ${TREE_SITTER_LANG} ${STP_BASE_DIRECTORY}/include replxx/include)
+TARGET_LINK_LIBRARIES(stp_interp PRIVATE steppable replxx)
+
+# Benchmarks
+OPTION(STP_BUILD_BENCHMARKS "Build benchmarks for the interpreter" OFF)
+IF(STP_BUILD_BENCHMARKS)
+    SET(STP_BENCH_SRC src/stpMatrixKernels.cpp src/stpFastMath.cpp src/stpThreadPool.cpp)
+    ADD_EXECUTABLE(stp_bench_matrix_kernels bench/stpBenchMatrixKernels.cpp ${STP_BENCH_SRC})
+    ADD_EXECUTABLE(stp_bench_gemm bench/stpBenchGemm.cpp ${STP_BENCH_SRC})
+    FOREACH(BENCH stp_bench_matrix_kernels stp_bench_gemm)
+        TARGET_INCLUDE_DIRECTORIES(${BENCH} PRIVATE src ${STP_BASE_DIRECTORY}/include)
+        TARGET_LINK_LIBRARIES(${BENCH} PRIVATE steppable)
+    ENDFOREACH()
+ENDIF()
@@ -49,6 +49,17 @@ namespace steppable::parser
 
         auto functionsVec = state->getCurrentScope()->functions;
 
+        // Builtins that need their arguments unevaluated, or that create child states
+        if (not functionsVec.contains(funcNameOrig))
+        {
+            if (funcNameOrig == "pmap")
+                return STP_processParallelMap(exprNode, state);
+            if (funcNameOrig == "spawn")
+                return STP_processSpawn(exprNode, state);
+            if (funcNameOrig == "await")
+                return STP_processAwait(exprNode, state);
+        }
+
         if (funcPtr == nullptr)
         {
             if (functionsVec.contains(funcNameOrig))
@@ -102,7 +113,7 @@ namespace steppable::parser
                 argMap.merge(declaredKeywordArgs);
                 argMap.merge(givenKeywordArgs);
 
-                return function.interpFn(argMap);
+                return function(state, argMap);
             }
             STP_throwError(
                 *exprNode, state, format::format("Function {0} is not defined."s, { funcNameOrig }));
@@ -110,6 +121,8 @@ namespace steppable::parser
         }
 
         std::vector<STP_Argument> fnArgsVec = STP_extractArgVector(exprNode, state);
+        if (state->shouldStop())
+            return STP_Value(STP_TypeID::NONE);
 
         auto args = STP_ArgContainer(fnArgsVec, {});
         auto* val = static_cast<STP_ValuePrimitive*>(funcPtr(&args));
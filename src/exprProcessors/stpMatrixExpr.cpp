@@ -31,6 +31,7 @@
 
 #include <cassert>
 #include <cstdint>
+#include <utility>
 
 using namespace std::literals;
 
@@ -55,20 +56,25 @@ namespace steppable::parser
                 TSNode cell = ts_node_child(node, i);
                 if (ts_node_type(cell) == ";"s)
                     continue;
-                STP_Value val = STP_handleExpr(&cell, state);
+                STP_Value val = STP_handleExpr(&cell, state).materialized();
 
                 if (val.typeID != STP_TypeID::NUMBER)
+                {
                     STP_throwError(cell, state, "Matrix should contain numbers only."s);
+                    return STP_Value(STP_TypeID::NONE);
+                }
 
-                auto value = std::any_cast<Number>(val.data);
-                currentMatRow.emplace_back(value);
+                currentMatRow.emplace_back(std::move(std::any_cast<Number&>(val.data)));
                 currentCols++;
             }
 
             if (lastColLength)
             {
                 if (currentCols != *lastColLength)
+                {
                     STP_throwError(node, state, "Matrix should contain numbers only."s);
+                    return STP_Value(STP_TypeID::NONE);
+                }
             }
             matVec.emplace_back(currentMatRow);
             lastColLength = std::make_unique<size_t>(currentCols);
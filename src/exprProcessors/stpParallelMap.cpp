@@ -0,0 +1,212 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include "steppable/mat2d.hpp"
+#include "stpInterp/stpBetterTS.hpp"
+#include "stpInterp/stpErrors.hpp"
+#include "stpInterp/stpExprHandler.hpp"
+#include "stpInterp/stpInit.hpp"
+#include "stpInterp/stpThreadPool.hpp"
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+using namespace steppable::utils;
+
+namespace steppable::parser
+{
+    namespace
+    {
+        /// Number of chunks per worker thread, so that uneven work is balanced between the threads.
+        constexpr size_t CHUNKS_PER_WORKER = 4;
+
+        /**
+         * @struct MapChunk
+         * @brief Results of one chunk of a parallel map.
+         */
+        struct MapChunk
+        {
+            std::string output; ///< Everything printed while running the chunk.
+            std::string error; ///< The first error of the chunk, or empty.
+            STP_LimitKind limitHit = STP_LimitKind::NONE; ///< The limit that stopped the chunk, if any.
+        };
+
+        /**
+         * @brief Get the function to map from the first argument of `pmap`, which names it.
+         *
+         * @param argNode The argument node.
+         * @param state The current state of the interpreter.
+         * @return The function, or `std::nullopt` if it does not exist or takes more than one positional argument.
+         */
+        std::optional<STP_FunctionDefinition> getMappedFunction(const TSNode& argNode, const STP_InterpState& state)
+        {
+            const std::string name = stringUtils::bothEndsReplace(state->getChunk(&argNode), ' ');
+            STP_FunctionDefinition function = state->getCurrentScope()->getFunction(&argNode, name, state);
+            if (not function.interpFn)
+                return std::nullopt;
+
+            if (function.posArgNames.size() != 1)
+            {
+                STP_throwError(argNode,
+                               state,
+                               format::format("Function {0} must take exactly one positional argument to be mapped"s,
+                                              { name }));
+                return std::nullopt;
+            }
+            return function;
+        }
+    } // namespace
+
+    STP_Value STP_processParallelMap(const TSNode* exprNode, const STP_InterpState& state)
+    {
+        // pmap(fn, matrix[, rows=...])
+        const TSNode posArgumentsNode = ts_node_named_child(*exprNode, 1);
+        if (ts_node_is_null(posArgumentsNode) or ts_node_named_child_count(posArgumentsNode) != 2)
+        {
+            STP_throwError(*exprNode, state, "pmap expects a function and a matrix"s);
+            return STP_Value(STP_TypeID::NONE);
+        }
+
+        const TSNode fnNode = ts_node_named_child(posArgumentsNode, 0);
+        const TSNode matrixNode = ts_node_named_child(posArgumentsNode, 1);
+        const auto function = getMappedFunction(fnNode, state);
+        if (not function)
+            return STP_Value(STP_TypeID::NONE);
+
+        const STP_Value matrixValue = STP_handleExpr(&matrixNode, state).materialized();
+        if (matrixValue.typeID != STP_TypeID::MATRIX_2D)
+        {
+            STP_throwError(matrixNode, state, "pmap can only be applied to matrices"s);
+            return STP_Value(STP_TypeID::NONE);
+        }
+
+        // rows=true passes whole rows to the function instead of elements.
+        bool byRows = false;
+        if (const TSNode kwArgumentsNode = ts_node_named_child(*exprNode, 2); not ts_node_is_null(kwArgumentsNode))
+        {
+            for (uint32_t i = 0; i < ts_node_named_child_count(kwArgumentsNode); i++)
+            {
+                const TSNode argNode = ts_node_named_child(kwArgumentsNode, i);
+                const TSNode argNameNode = ts_node_child_by_field_name(argNode, "argument_name"s);
+                const TSNode argExprNode = ts_node_next_named_sibling(argNameNode);
+                if (const std::string argName = state->getChunk(&argNameNode); argName != "rows")
+                {
+                    STP_throwError(argNode, state, format::format("Unknown argument {0} of pmap"s, { argName }));
+                    return STP_Value(STP_TypeID::NONE);
+                }
+                byRows = STP_handleExpr(&argExprNode, state).asBool(&argExprNode, state);
+            }
+        }
+
+        const auto& data = std::any_cast<const Matrix&>(matrixValue.data).getData();
+        const size_t rows = data.size();
+        const size_t cols = rows == 0 ? 0 : data.front().size();
+        const size_t count = byRows ? rows : rows * cols;
+        if (count == 0 or state->shouldStop())
+            return matrixValue;
+
+        std::vector<STP_Value> results(count, STP_Value(STP_TypeID::NONE));
+        auto& pool = STP_ThreadPool::shared();
+        const size_t grain = std::max<size_t>(1, count / ((pool.size() + 1) * CHUNKS_PER_WORKER));
+        std::vector<MapChunk> chunks((count + grain - 1) / grain);
+
+        pool.parallelFor(0, count, grain, [&](const size_t begin, const size_t end) {
+            // Each chunk runs in a state of its own, so that it has its own scopes.
+            MapChunk& chunk = chunks[begin / grain];
+            const STP_InterpState child = STP_createChildState(state);
+            child->getOutput().captureTo(&chunk.output);
+
+            for (size_t i = begin; i < end and not child->shouldStop(); i++)
+            {
+                STP_Value argument(STP_TypeID::NONE);
+                if (byRows)
+                    argument = STP_Value(STP_TypeID::MATRIX_2D, Matrix({ data[i] }));
+                else
+                    argument = STP_Value(STP_TypeID::NUMBER, data[i / cols][i % cols]);
+
+                STP_StringValMap args = function->keywordArgs;
+                args.insert_or_assign(function->posArgNames.front(), argument);
+                results[i] = (*function)(child, args).materialized();
+            }
+
+            child->getOutput().flush();
+            chunk.error = child->getError();
+            chunk.limitHit = child->getLimitHit();
+        });
+
+        // Report output and the first error in the order of the elements.
+        for (const MapChunk& chunk : chunks)
+        {
+            state->getOutput().write(chunk.output);
+            if (chunk.limitHit != STP_LimitKind::NONE)
+            {
+                state->hitLimit(chunk.limitHit);
+                return STP_Value(STP_TypeID::NONE);
+            }
+            if (not chunk.error.empty())
+            {
+                STP_rethrowChildError(*exprNode, state, chunk.error);
+                return STP_Value(STP_TypeID::NONE);
+            }
+        }
+        if (state->shouldStop())
+            return STP_Value(STP_TypeID::NONE);
+
+        // Gather the results into a matrix of the same shape, or one row per row when mapping rows.
+        MatVec2D<Number> resultData;
+        resultData.reserve(rows);
+        for (size_t i = 0; i < count; i++)
+        {
+            const STP_Value& result = results[i];
+            if (byRows and result.typeID == STP_TypeID::MATRIX_2D and
+                std::any_cast<const Matrix&>(result.data).getRows() == 1)
+            {
+                resultData.emplace_back(std::any_cast<const Matrix&>(result.data).getData().front());
+                continue;
+            }
+            if (result.typeID != STP_TypeID::NUMBER)
+            {
+                STP_throwError(*exprNode,
+                               state,
+                               byRows ? "Function of pmap must return a number or a row for each row"s
+                                      : "Function of pmap must return a number for each element"s);
+                return STP_Value(STP_TypeID::NONE);
+            }
+
+            if (byRows or i % cols == 0)
+                resultData.emplace_back();
+            resultData.back().emplace_back(std::any_cast<const Number&>(result.data));
+        }
+
+        if (byRows and std::ranges::any_of(resultData, [&](const auto& row) {
+                return row.size() != resultData.front().size();
+            }))
+        {
+            STP_throwError(*exprNode, state, "Rows returned by the function of pmap must have the same length"s);
+            return STP_Value(STP_TypeID::NONE);
+        }
+        return STP_Value(STP_TypeID::MATRIX_2D, Matrix(resultData));
+    }
+} // namespace steppable::parser
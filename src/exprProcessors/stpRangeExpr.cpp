@@ -23,6 +23,7 @@
 #include "steppable/mat2d.hpp"
 #include "stpInterp/stpBetterTS.hpp"
 #include "stpInterp/stpInit.hpp"
+#include "stpInterp/stpInterrupt.hpp"
 #include "stpInterp/stpStore.hpp"
 #include "tree_sitter/api.h"
 
@@ -31,6 +32,12 @@ using namespace std::literals;
 
 namespace steppable::parser
 {
+    namespace
+    {
+        /// Number of elements of a range between checks of the step and time limits.
+        constexpr size_t RANGE_CHECK_INTERVAL = 4096;
+    } // namespace
+
     STP_Value STP_handleRangeExpr(const TSNode* exprNode, const STP_InterpState& state)
     {
         TSNode startNode = ts_node_child_by_field_name(*exprNode, "start"s);
@@ -59,7 +66,16 @@ namespace steppable::parser
         std::vector<Number> row;
         // include end as well
         for (Number i = startN; i <= endN; i += stepN)
+        {
+            if (not state->checkValueSize(sizeof(Number), row.size() + 1))
+                return STP_Value(STP_TypeID::NONE);
+
+            // A range may be endless, e.g., with a step of 0. Interrupts are checked on every element, and the other
+            // safepoint checks once in a while, so that a long range does not count as many steps.
+            if ((STP_isInterruptRequested() or row.size() % RANGE_CHECK_INTERVAL == 0) and state->shouldStop())
+                return STP_Value(STP_TypeID::NONE);
             row.emplace_back(i);
+        }
 
         Matrix mat({ row });
         return STP_Value(STP_TypeID::MATRIX_2D, mat);
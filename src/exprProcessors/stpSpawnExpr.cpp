@@ -0,0 +1,115 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include "stpInterp/stpBetterTS.hpp"
+#include "stpInterp/stpErrors.hpp"
+#include "stpInterp/stpExprHandler.hpp"
+#include "stpInterp/stpFuture.hpp"
+#include "stpInterp/stpInit.hpp"
+
+#include <exception>
+#include <future>
+#include <memory>
+#include <string>
+
+using namespace std::literals;
+
+namespace steppable::parser
+{
+    namespace
+    {
+        /**
+         * @brief Get the only positional argument of a builtin call.
+         *
+         * @param exprNode The function call expression node.
+         * @param state The current state of the interpreter.
+         * @param builtinName The name of the builtin, for reporting errors.
+         * @return The argument node, or a null node if the call does not have exactly one positional argument.
+         */
+        TSNode getOnlyArgument(const TSNode* exprNode, const STP_InterpState& state, const std::string& builtinName)
+        {
+            const TSNode posArgumentsNode = ts_node_named_child(*exprNode, 1);
+            if (ts_node_is_null(posArgumentsNode) or ts_node_named_child_count(posArgumentsNode) != 1 or
+                not ts_node_is_null(ts_node_named_child(*exprNode, 2)))
+            {
+                STP_throwError(*exprNode, state, format::format("{0} expects one expression"s, { builtinName }));
+                return TSNode{};
+            }
+            return ts_node_named_child(posArgumentsNode, 0);
+        }
+    } // namespace
+
+    STP_Value STP_processSpawn(const TSNode* exprNode, const STP_InterpState& state)
+    {
+        TSNode argNode = getOnlyArgument(exprNode, state, "spawn"s);
+        if (ts_node_is_null(argNode) or state->shouldStop())
+            return STP_Value(STP_TypeID::NONE);
+
+        // Snapshot the scope now, so that later assignments do not affect the task.
+        const STP_InterpState child = STP_createChildState(state);
+
+        // The tree of the statement may be deleted before the task finishes, e.g., in the REPL. Keep a copy of it,
+        // and let the node refer to the copy.
+        TSTree* tree = ts_tree_copy(argNode.tree);
+        argNode.tree = tree;
+
+        const auto task = [child, argNode, tree]() {
+            STP_FutureResult result;
+            child->getOutput().captureTo(&result.output);
+            try
+            {
+                result.value = STP_handleExpr(&argNode, child);
+                result.value = STP_resolveFuture(result.value, &argNode, child).materialized();
+            }
+            catch (const std::exception& exception)
+            {
+                child->setError(exception.what());
+            }
+            child->getOutput().captureTo(nullptr);
+
+            result.error = child->getError();
+            result.limitHit = child->getLimitHit();
+            if (result.error.empty() and result.limitHit == STP_LimitKind::NONE and
+                child->getExecState() == STP_ExecState::REQUEST_STOP)
+                result.error = "The task was stopped before it finished"s;
+            ts_tree_delete(tree);
+            return result;
+        };
+
+        auto future = std::make_shared<STP_Future>();
+        future->result = std::async(std::launch::async, task).share();
+        future->state = child;
+
+        STP_Value value(STP_TypeID::NONE);
+        value.future = std::move(future);
+        return value;
+    }
+
+    STP_Value STP_processAwait(const TSNode* exprNode, const STP_InterpState& state)
+    {
+        const TSNode argNode = getOnlyArgument(exprNode, state, "await"s);
+        if (ts_node_is_null(argNode))
+            return STP_Value(STP_TypeID::NONE);
+
+        return STP_resolveFuture(STP_handleExpr(&argNode, state), &argNode, state);
+    }
+} // namespace steppable::parser
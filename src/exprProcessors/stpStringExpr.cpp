@@ -27,44 +27,94 @@ using namespace std::literals;
 
 namespace steppable::parser
 {
-    STP_Value STP_handleStringExpr(const TSNode* exprNode, const STP_InterpState& state)
+    namespace
     {
-        // String
-        std::string data;
-        for (uint32_t i = 0; i < ts_node_child_count(*exprNode); i++)
+        /**
+         * @brief Split a string literal into literal segments and formatting snippets, decoding escapes.
+         *
+         * @param exprNode The string literal node.
+         * @param state The current state of the interpreter.
+         * @return The template of the string literal.
+         */
+        STP_StringTemplate compileStringTemplate(const TSNode* exprNode, const STP_InterpState& state)
         {
-            auto childNode = ts_node_child(*exprNode, i);
-            const std::string childNodeType = ts_node_type(childNode);
+            STP_StringTemplate stringTemplate;
+            std::string literal;
 
-            if (childNodeType == "string_char")
-                data += state->getChunk(&childNode);
-            else if (childNodeType == "unicode_escape")
+            for (uint32_t i = 0; i < ts_node_child_count(*exprNode); i++)
             {
-                auto hexDigitsNode = ts_node_named_child(childNode, 0);
-                const std::string hexCode = state->getChunk(&hexDigitsNode);
+                auto childNode = ts_node_child(*exprNode, i);
+                const std::string childNodeType = ts_node_type(childNode);
 
-                unsigned long codePoint = std::stoul(hexCode, nullptr, 16);
-                std::string text = stringUtils::unicodeToUtf8(static_cast<int>(codePoint));
-                data += text;
-            }
-            else if (childNodeType == "octal_escape")
-            {
-                std::string octDigits = state->getChunk(&childNode);
-                octDigits.erase(octDigits.begin()); // Erase leading '\' character
+                if (childNodeType == "string_char")
+                    literal += state->getChunkView(&childNode);
+                else if (childNodeType == "unicode_escape")
+                {
+                    auto hexDigitsNode = ts_node_named_child(childNode, 0);
+                    const std::string hexCode = state->getChunk(&hexDigitsNode);
 
-                unsigned long codePoint = std::stoul(octDigits, nullptr, 8);
-                std::string text = stringUtils::unicodeToUtf8(static_cast<int>(codePoint));
-                data += text;
+                    unsigned long codePoint = std::stoul(hexCode, nullptr, 16);
+                    literal += stringUtils::unicodeToUtf8(static_cast<int>(codePoint));
+                }
+                else if (childNodeType == "octal_escape")
+                {
+                    std::string octDigits = state->getChunk(&childNode);
+                    octDigits.erase(octDigits.begin()); // Erase leading '\' character
+
+                    unsigned long codePoint = std::stoul(octDigits, nullptr, 8);
+                    literal += stringUtils::unicodeToUtf8(static_cast<int>(codePoint));
+                }
+                else if (childNodeType == "formatting_snippet")
+                {
+                    if (not literal.empty())
+                    {
+                        stringTemplate.literalSize += literal.size();
+                        stringTemplate.segments.push_back({ .literal = std::move(literal) });
+                        literal.clear();
+                    }
+                    auto formatExprNode = ts_node_child_by_field_name(childNode, "formatting_expr"s);
+                    stringTemplate.segments.push_back({ .literal = {}, .hole = formatExprNode, .isHole = true });
+                }
             }
-            else if (childNodeType == "formatting_snippet")
-            {
-                auto formatExprNode = ts_node_child_by_field_name(childNode, "formatting_expr"s);
-                STP_Value value = STP_handleExpr(&formatExprNode, state, false, "");
 
-                data += value.present("", false);
+            if (not literal.empty())
+            {
+                stringTemplate.literalSize += literal.size();
+                stringTemplate.segments.push_back({ .literal = std::move(literal) });
             }
+            return stringTemplate;
+        }
+    } // namespace
+
+    STP_Value STP_handleStringExpr(const TSNode* exprNode, const STP_InterpState& state)
+    {
+        // String
+        // Held by reference count, as snippets may switch the chunk and drop the cached templates
+        std::shared_ptr<const STP_StringTemplate> stringTemplate = state->findStringTemplate(exprNode);
+        if (stringTemplate == nullptr)
+            stringTemplate = state->addStringTemplate(exprNode, compileStringTemplate(exprNode, state));
+
+        // Only one segment, no formatting snippets
+        if (stringTemplate->segments.size() == 1 and not stringTemplate->segments.front().isHole)
+            return STP_Value(STP_TypeID::STRING, stringTemplate->segments.front().literal);
+
+        // Evaluate all snippets first so that the result is allocated only once
+        std::vector<std::string> snippets;
+        size_t size = stringTemplate->literalSize;
+        for (const auto& segment : stringTemplate->segments)
+        {
+            if (not segment.isHole)
+                continue;
+            const STP_Value value = STP_handleExpr(&segment.hole, state, false, "");
+            size += snippets.emplace_back(value.presentMaterialized("", false)).size();
         }
 
+        std::string data;
+        data.reserve(size);
+        auto snippet = snippets.begin();
+        for (const auto& segment : stringTemplate->segments)
+            data += segment.isHole ? *snippet++ : segment.literal;
+
         return STP_Value(STP_TypeID::STRING, data);
     }
 } // namespace steppable::parser
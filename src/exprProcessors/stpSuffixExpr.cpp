@@ -24,9 +24,12 @@
 #include "stpInterp/stpBetterTS.hpp"
 #include "stpInterp/stpErrors.hpp"
 #include "stpInterp/stpExprHandler.hpp"
+#include "stpInterp/stpFactorial.hpp"
 #include "stpInterp/stpInit.hpp"
 #include "stpInterp/stpStore.hpp"
 
+#include <utility>
+
 using namespace std::literals;
 using namespace steppable::utils;
 
@@ -36,9 +39,9 @@ namespace steppable::parser
     {
         TSNode opNode = ts_node_child_by_field_name(*exprNode, "operator"s);
         TSNode valueNode = ts_node_prev_sibling(opNode);
-        STP_Value value = STP_handleExpr(&valueNode, state);
+        STP_Value value = STP_handleExpr(&valueNode, state).materialized();
 
-        STP_Value retValue(value.typeID, value.data);
+        STP_Value retValue(STP_TypeID::NONE);
 
         char op = *ts_node_type(opNode);
 
@@ -50,41 +53,50 @@ namespace steppable::parser
             if (value.typeID != STP_TypeID::MATRIX_2D)
             {
                 STP_throwError(*exprNode, state, "Cannot perform transpose on a non-matrix object"s);
-                programSafeExit(1);
+                return STP_Value(STP_TypeID::NONE);
             }
 
-            auto mat = std::any_cast<Matrix>(value.data);
-            mat = mat.transpose();
-            retValue = STP_Value(STP_TypeID::MATRIX_2D, mat);
+            retValue = STP_Value(STP_TypeID::MATRIX_2D, std::any_cast<const Matrix&>(value.data).transpose());
             break;
         }
         case '!':
         {
-            // Factorial
+            // Factorial. An interrupted factorial is missing some factors, so no value is given.
+            STP_FactorialEngine factorial(state->getCancelToken());
             if (value.typeID == STP_TypeID::NUMBER)
             {
-                auto num = std::any_cast<Number>(value.data);
-                num = calc::factorial(num.present(), 0);
-                retValue = STP_Value(STP_TypeID::NUMBER, num);
+                const auto num = factorial(std::any_cast<const Number&>(value.data));
+                if (not num)
+                    return STP_Value(STP_TypeID::NONE);
+                retValue = STP_Value(STP_TypeID::NUMBER, *num);
             }
             else if (value.typeID == STP_TypeID::MATRIX_2D)
             {
-                auto mat = std::any_cast<Matrix>(value.data);
-                mat = mat.apply([&](const Number& item, const YXPoint& /*unused*/) -> Number {
-                    return calc::factorial(item.present(), 0);
-                });
+                // One engine for all elements, so that repeated values are calculated once.
+                bool cancelled = false;
+                auto mat = std::any_cast<const Matrix&>(value.data).apply(
+                    [&](const Number& item, const YXPoint& /*unused*/) -> Number {
+                        if (cancelled)
+                            return item;
+                        auto result = factorial(item);
+                        cancelled = not result;
+                        return result ? *std::move(result) : item;
+                    });
+                if (cancelled)
+                    return STP_Value(STP_TypeID::NONE);
                 retValue = STP_Value(STP_TypeID::MATRIX_2D, mat);
             }
             else
             {
                 STP_throwError(*exprNode, state, "Factorial can only be applied to matrices and numbers"s);
-                programSafeExit(1);
+                return STP_Value(STP_TypeID::NONE);
             }
             break;
         }
         default:
         {
             // Should not reach here
+            retValue = std::move(value);
         }
         }
         return retValue;
@@ -23,18 +23,26 @@
 #include "argParse.hpp"
 #include "colors.hpp"
 #include "output.hpp"
+#include "stpInterp/stpBatch.hpp"
 #include "stpInterp/stpErrors.hpp"
 #include "stpInterp/stpInit.hpp"
 #include "stpInterp/stpInteractive.hpp"
+#include "stpInterp/stpInterrupt.hpp"
+#include "stpInterp/stpOptions.hpp"
 #include "stpInterp/stpProcessor.hpp"
+#include "stpInterp/stpServer.hpp"
+#include "stpInterp/stpSnapshot.hpp"
+#include "stpInterp/stpSourceBuffer.hpp"
+#include "stpInterp/stpStreaming.hpp"
+#include "stpInterp/stpWatch.hpp"
 
 #include <cassert>
-#include <fstream>
 #include <iostream>
 #include <memory>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 extern "C" {
 #include <tree_sitter/api.h>
@@ -65,18 +73,73 @@ int main(int argc, const char** argv) // NOLINT(*-exception-escape)
 
     TSNode rootNode;
 
-    std::ifstream file;
-    std::string source;
+    std::shared_ptr<STP_SourceBuffer> source;
+    std::string_view sourceText;
 
     const STP_InterpState state = STP_getState();
     std::string path;
 
-    ProgramArgs program(argc, argv);
+    STP_Options options;
+    const bool optionsValid = STP_parseOptions(argc, argv, options);
+
+    std::vector<const char*> programArgv;
+    programArgv.reserve(options.positionalArgs.size());
+    for (const auto& arg : options.positionalArgs)
+        programArgv.emplace_back(arg.c_str());
+
+    ProgramArgs program(static_cast<int>(programArgv.size()), programArgv.data());
     program.addPosArg('p', "Path to STP file", false);
 
     STP_init();
 
-    if (argc == 1)
+    if (not optionsValid)
+    {
+        ret = 1;
+        goto end;
+    }
+    if (options.fastMath)
+        state->setFastMath();
+    state->getOutput().setBufferSize(options.outputBufferSize);
+    state->getOutput().setFlushPolicy(options.flushPolicy);
+    state->setLimits(options.limits);
+
+    if (not options.servePath.empty())
+    {
+        ret = STP_runServer(options.servePath, options);
+        goto end;
+    }
+
+    if (options.batch)
+    {
+        std::vector<std::string> paths(options.positionalArgs.begin() + 1, options.positionalArgs.end());
+        if (not options.manifest.empty() and not STP_readManifest(options.manifest, paths))
+        {
+            ret = 1;
+            output::error("parser"s, "Unable to open manifest {0}"s, { options.manifest });
+            goto end;
+        }
+
+        ret = STP_runBatch(paths, { .jobs = options.jobs, .fastMath = options.fastMath, .limits = options.limits });
+        goto end;
+    }
+
+    if (not options.snapshotIn.empty() and not STP_loadSnapshot(options.snapshotIn, state, parser))
+    {
+        ret = 1;
+        goto end;
+    }
+
+    // [Ctrl-C] stops the evaluation at its next safepoint, instead of killing the process.
+    STP_installInterruptHandler();
+
+    if (options.stream)
+    {
+        state->setFile("<stream>");
+        ret = STP_runStreaming(stdin, state, parser);
+        goto end;
+    }
+
+    if (programArgv.size() == 1)
     {
         if (isInputTerminal())
         {
@@ -90,8 +153,7 @@ int main(int argc, const char** argv) // NOLINT(*-exception-escape)
         else
         {
             // Read from stdin
-            for (std::string line; std::getline(std::cin, line);)
-                source += line + "\n";
+            source = STP_SourceBuffer::fromStream(stdin);
         }
     }
     else
@@ -100,49 +162,48 @@ int main(int argc, const char** argv) // NOLINT(*-exception-escape)
         path = program.getPosArg(0);
 
         state->setFile(path);
-        // Read the entire file at once
-        file = std::ifstream(path, std::ios::in | std::ios::binary);
-        if (not file)
+        if (options.watch)
+        {
+            ret = STP_runWatch(path, state, parser);
+            goto end;
+        }
+
+        // Map the entire file at once
+        source = STP_SourceBuffer::fromFile(path);
+        if (source == nullptr)
         {
             ret = 1;
             output::error("parser"s, "Unable to open file {0}"s, { path });
             goto end;
         }
 
-        std::array<char, 32> buffer{};
-        file.read(buffer.data(), buffer.size());
-        std::streamsize bytesRead = file.gcount();
-        std::string firstPart(buffer.data(), bytesRead);
-        if (const size_t offset = stringUtils::findFirstNonUtf8(firstPart); std::cmp_less(offset , bytesRead))
+        sourceText = source->view();
+        if (const size_t offset = STP_findFirstNonUtf8(sourceText); offset < sourceText.size())
         {
             output::error("parser"s, "Input is not UTF-8!"s);
             output::info("parser"s, "\\x{0} at offset {1} is not valid UTF-8"s, {
-                stringUtils::intToHex(firstPart[offset]),
+                stringUtils::intToHex(sourceText[offset]),
                 std::to_string(offset),
             });
 
             ret = 1;
-            file.close();
             goto end;
         }
-
-        std::string rest;
-        if (file)
-        { // If not at EOF
-            rest.assign(std::istreambuf_iterator(file), std::istreambuf_iterator<char>());
-        }
-        source = firstPart + rest;
-
-        file.close();
     }
 
-    tree = ts_parser_parse_string(parser, nullptr, source.c_str(), static_cast<uint32_t>(source.size()));
+    sourceText = source->view();
+    tree = ts_parser_parse_string(parser, nullptr, sourceText.data(), static_cast<uint32_t>(sourceText.size()));
     rootNode = ts_tree_root_node(tree);
-    state->setChunk(source, 0, static_cast<long>(source.size()));
+    state->setChunk(source);
     if (STP_checkRecursiveNodeSanity(rootNode, state))
         return 1;
 
+    state->startEvaluation();
     STP_processChunkChild(rootNode, state);
+    if (state->getLimitHit() != STP_LimitKind::NONE or STP_isInterruptRequested())
+        ret = 1;
+    else if (not options.snapshotOut.empty() and not STP_saveSnapshot(options.snapshotOut, state))
+        ret = 1;
 
 end:
     if (tree != nullptr)
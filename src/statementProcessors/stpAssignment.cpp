@@ -31,6 +31,86 @@ using namespace std::literals;
 
 namespace steppable::parser
 {
+    namespace
+    {
+        /**
+         * @brief Check whether an expression calls a function, which may assign to variables.
+         *
+         * @param node The expression node.
+         * @return True if the expression contains a function call. False otherwise.
+         */
+        bool containsCall(const TSNode& node)
+        {
+            if (ts_node_type(node) == "function_call"s)
+                return true;
+            for (uint32_t i = 0; i < ts_node_named_child_count(node); i++)
+                if (containsCall(ts_node_named_child(node, i)))
+                    return true;
+            return false;
+        }
+
+        /**
+         * @brief Handle `name = name + expr` on strings by appending to the stored string in place.
+         * @details The string grows geometrically, so building a string in a loop takes amortised constant time per
+         * append instead of copying the whole string every time. Expressions with function calls are left to a normal
+         * assignment, as they may assign to the variable, and the variable is read before them.
+         *
+         * @param name The name of the variable being assigned to.
+         * @param exprNode The expression node on the RHS of the assignment.
+         * @param state The current state of the interpreter.
+         * @param printValue Whether to print the assigned value.
+         *
+         * @return True if the assignment is handled. False if it should be handled as a normal assignment.
+         */
+        bool appendInPlace(const std::string& name,
+                           const TSNode& exprNode,
+                           const STP_InterpState& state,
+                           const bool printValue)
+        {
+            // binary_expression := lhs 'operator' rhs
+            if (ts_node_type(exprNode) != "binary_expression"s)
+                return false;
+            const TSNode binExprNode = ts_node_child(exprNode, 0);
+            const TSNode lhsNode = ts_node_child(binExprNode, 0);
+            const TSNode operatorNode = ts_node_child(ts_node_child(binExprNode, 1), 0);
+            const TSNode rhsNode = ts_node_child(binExprNode, 2);
+
+            if (ts_node_type(operatorNode) != "+"s or ts_node_type(lhsNode) != "identifier_or_member_access"s)
+                return false;
+            const TSNode lhsNameNode = ts_node_child(lhsNode, 0);
+            if (ts_node_type(lhsNameNode) != "identifier"s or state->getChunk(&lhsNameNode) != name or
+                containsCall(rhsNode))
+                return false;
+
+            const STP_Value* stored = state->getCurrentScope()->findVariable(name);
+            if (stored == nullptr or stored->typeID != STP_TypeID::STRING or stored->getIsConstant())
+                return false;
+
+            // The RHS cannot assign to any variable, so it makes no difference that it is evaluated first. The
+            // variable is looked up again afterwards, as evaluating may resolve futures and replace stored values.
+            const STP_Value rhs = STP_handleExpr(&rhsNode, state);
+            STP_Value* variable = state->getCurrentScope()->findVariable(name);
+            if (variable == nullptr or variable->typeID != STP_TypeID::STRING)
+                return false;
+
+            if (rhs.typeID == STP_TypeID::STRING)
+            {
+                auto* str = std::any_cast<std::string>(&variable->data);
+                const auto& rhsStr = std::any_cast<const std::string&>(rhs.data);
+                if (state->checkValueSize(1, str->size() + rhsStr.size()))
+                    str->append(rhsStr);
+            }
+            else if (rhs.typeID != STP_TypeID::NONE)
+                *variable = variable->applyBinaryOperator(&exprNode, ts_node_type(operatorNode), rhs, state);
+            else
+                *variable = STP_Value(STP_TypeID::NONE, nullptr);
+
+            if (printValue and variable->typeID != STP_TypeID::NONE)
+                state->getOutput().writeLine(variable->present(name));
+            return true;
+        }
+    } // namespace
+
     void STP_handleAssignment(const TSNode* node, const STP_InterpState& state = nullptr)
     {
         // assignment := nameNode "=" exprNode
@@ -50,15 +130,22 @@ namespace steppable::parser
         STP_Scope* current_scope = state->getCurrentScope();
         if (current_scope->variables.contains(name))
         {
-            const STP_Value existingVar = current_scope->getVariable(node, name);
+            const STP_Value existingVar = current_scope->getVariable(node, name, state);
             if (existingVar.getIsConstant())
             {
-                STP_throwError(*node, STP_getState(), "Re-assigning constant variables.");
+                STP_throwError(*node, state, "Re-assigning constant variables.");
                 return;
             }
         }
+        if (appendInPlace(name, exprNode, state, printValue))
+            return;
+
         // Write to scope / global variables
         const STP_Value val = STP_handleExpr(&exprNode, state, printValue, name);
+
+        // The value may be incomplete if the evaluation was interrupted.
+        if (state->shouldStop())
+            return;
         current_scope->addVariable(name, val);
     }
 } // namespace steppable::parser
@@ -35,7 +35,7 @@ using namespace steppable::utils;
 
 namespace steppable::parser
 {
-    void processChunk(const TSNode& node, const STP_InterpState& state)
+    void STP_processStatement(const TSNode& node, const STP_InterpState& state)
     {
         const std::string type = ts_node_type(node);
 
@@ -163,7 +163,10 @@ namespace steppable::parser
         const size_t childCount = ts_node_child_count(parent);
         for (uint32_t i = 0; i < childCount; ++i)
         {
-            processChunk(ts_node_child(parent, i), stpState);
+            if (stpState->shouldStop())
+                break;
+
+            STP_processStatement(ts_node_child(parent, i), stpState);
             if (stpState->getExecState() == STP_ExecState::RETURNED)
             {
                 stpState->setExecState(STP_ExecState::NORMAL);
@@ -72,13 +72,24 @@ namespace steppable::parser
         if (STP_checkRecursiveNodeSanity(bodyNode, state))
             return;
 
-        TSTree* bodyNodeTree = ts_tree_copy(bodyNode.tree);
-
+        // The tree of the declaration may be deleted while the function is still declared, e.g., in the REPL or when
+        // restoring a snapshot. Keep a copy of it, and let the body node refer to the copy.
         STP_FunctionDefinition fn;
+        fn.fnTree = std::shared_ptr<TSTree>(ts_tree_copy(bodyNode.tree), ts_tree_delete);
         fn.fnNode = bodyNode;
-        fn.fnTree = bodyNodeTree;
+        fn.fnNode.tree = fn.fnTree.get();
+        fn.source = state->getChunk(node);
+
+        // The body may run after its chunk has been replaced, e.g., in the REPL or when streaming.
+        const std::shared_ptr<STP_ChunkContext> fnChunk = state->getChunkContext();
+
+        // The state is passed in by the caller rather than captured, so that the function runs in the calling context.
+        fn.interpFn = [=](const STP_InterpState& state, const STP_StringValMap& map) -> STP_Value {
+            if (state->shouldStop())
+                return STP_Value(STP_TypeID::NONE);
 
-        fn.interpFn = [=](const STP_StringValMap& map) -> STP_Value {
+            const std::shared_ptr<STP_ChunkContext> callerChunk = state->getChunkContext();
+            state->setChunkContext(fnChunk);
             STP_Scope scope = state->addChildScope();
 
             scope.variables = map;
@@ -88,8 +99,9 @@ namespace steppable::parser
             state->setCurrentScope(&scope);
 
             STP_processChunkChild(fn.fnNode, state, false);
-            STP_Value ret = state->getCurrentScope()->getVariable(node, "04795");
+            STP_Value ret = state->getCurrentScope()->getVariable(&fn.fnNode, "04795", state);
             state->setCurrentScope(state->getCurrentScope()->parentScope);
+            state->setChunkContext(callerChunk);
 
             return ret;
         };
@@ -39,7 +39,7 @@ namespace steppable::parser
         TSNode ifClauseStmtNode = ts_node_next_named_sibling(exprNode);
         TSNode lastNode = ifClauseStmtNode;
 
-        if (res.asBool(&exprNode))
+        if (res.asBool(&exprNode, state))
         {
             STP_processChunkChild(ifClauseStmtNode, state, true);
             return;
@@ -64,7 +64,7 @@ namespace steppable::parser
             TSNode elseifClauseStmtNode = ts_node_named_child(elseifClauseNode, 1);
             res = STP_handleExpr(&elseifExprNode, state);
 
-            if (res.asBool(&exprNode))
+            if (res.asBool(&exprNode, state))
             {
                 STP_processChunkChild(elseifClauseStmtNode, state, true);
                 return;
@@ -21,7 +21,7 @@ namespace steppable::parser
         if (ts_node_is_null(bodyNode))
         {
             STP_throwError(*node, state, "No statements in while loop"s);
-            utils::programSafeExit(1);
+            return;
         }
 
         // Create one scope for the entire loop body
@@ -33,11 +33,12 @@ namespace steppable::parser
         size_t times = 0;
         while (true)
         {
-            if (state->getExecState() == STP_ExecState::REQUEST_STOP)
+            // Loop back-edge
+            if (state->shouldStop())
                 break;
 
             loopVal = STP_handleExpr(&exprNode, state);
-            if (not loopVal.asBool(&exprNode))
+            if (not loopVal.asBool(&exprNode, state))
                 break;
 
             STP_processChunkChild(bodyNode, state);
@@ -24,16 +24,76 @@
 
 #include "steppable/mat2d.hpp"
 #include "stpInterp/stpErrors.hpp"
+#include "stpInterp/stpFastMath.hpp"
+#include "stpInterp/stpMatrixKernels.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string>
 
 using namespace std::literals;
 
 namespace steppable::parser
 {
+    namespace
+    {
+        /**
+         * @brief Repeat a string. The result is allocated once.
+         *
+         * @param node The binary operation node, for reporting errors.
+         * @param str The string to repeat.
+         * @param times How many times to repeat the string. Non-integral values are rounded up, as in counting
+         * `0, 1, 2, ...` while below `times`.
+         * @param state The current state of the interpreter.
+         * @return The repeated string, or an empty string if it would be larger than allowed.
+         */
+        std::string repeatString(const TSNode* node,
+                                 const std::string& str,
+                                 const Number& times,
+                                 const STP_InterpState& state)
+        {
+            size_t count = 0;
+            if (const auto integer = STP_numberToInteger(times))
+                count = *integer > 0 ? static_cast<size_t>(*integer) : 0;
+            else
+            {
+                // Counts beyond int64 may also be beyond `double`, where `strtod` gives infinity instead of throwing.
+                // Clamp them before converting, as converting an out-of-range `double` is undefined.
+                const std::string text = times.present();
+                if (const double real = std::strtod(text.c_str(), nullptr); real >= static_cast<double>(SIZE_MAX))
+                    count = SIZE_MAX;
+                else if (real > 0)
+                    count = static_cast<size_t>(std::ceil(real));
+            }
+
+            if (str.empty() or count == 0)
+                return {};
+            if (count > std::string().max_size() / str.size())
+            {
+                STP_throwError(*node,
+                               state,
+                               format::format("String repeated {0} times is too long."s, { times.present() }));
+                return {};
+            }
+            if (not state->checkValueSize(str.size(), count))
+                return {};
+
+            std::string result;
+            result.reserve(str.size() * count);
+            for (size_t i = 0; i < count; i++)
+                result.append(str);
+            return result;
+        }
+    } // namespace
+
     // NOLINTNEXTLINE(readability-function-cognitive-complexity)
     std::unique_ptr<STP_TypeID> determineBinaryOperationFeasibility(const TSNode* node,
                                                                     const STP_TypeID lhsType,
                                                                     const std::string& operatorStr,
-                                                                    const STP_TypeID rhsType)
+                                                                    const STP_TypeID rhsType,
+                                                                    const STP_InterpState& state)
     {
         // Make sure the operation can be performed
         //
@@ -67,8 +127,9 @@ namespace steppable::parser
         // ^            matrix         number       matrix              Matrix power
         // ^            number         matrix       number              * Implementation pending
         //
-        // == != > <    any            any          number (0, 1)       If lhs and rhs are number / string
-        // <= >=                                    matrix              If lhs or rhs is matrix
+        // == !=        any            any          number (0, 1)       lhs and rhs must be the same type.
+        // > < <= >=    any            any          number (0, 1)       If lhs and rhs are number / string
+        //                                          matrix              If lhs or rhs is matrix
         //                                                              lhs and rhs must be the same type.
         //
         // [fn call]    any            any          any                 Depends on implementation
@@ -143,7 +204,9 @@ namespace steppable::parser
                  operatorStr == ">=" or operatorStr == "<=")
         {
             operationPerformable = lhsType == rhsType;
-            if (lhsType == STP_TypeID::MATRIX_2D or rhsType == STP_TypeID::MATRIX_2D)
+            // Matrices are compared as a whole with `==` and `!=`, and element-wise with the other operators.
+            if ((lhsType == STP_TypeID::MATRIX_2D or rhsType == STP_TypeID::MATRIX_2D) and operatorStr != "==" and
+                operatorStr != "!=")
                 retType = STP_TypeID::MATRIX_2D;
             else
                 retType = STP_TypeID::NUMBER;
@@ -163,7 +226,7 @@ namespace steppable::parser
         if (not operationPerformable)
         {
             STP_throwError(*node,
-                           STP_getState(),
+                           state,
                            format::format("Operation ({0}) {1} ({2}) cannot be performed."s,
                                                        {
                                                            STP_typeNames.at(lhsType),
@@ -178,7 +241,8 @@ namespace steppable::parser
 
     std::unique_ptr<STP_TypeID> determineUnaryOperationFeasibility(const TSNode* node,
                                                                    const std::string& operatorString,
-                                                                   const STP_TypeID type)
+                                                                   const STP_TypeID type,
+                                                                   const STP_InterpState& state)
     {
         bool operationPerformable = type == STP_TypeID::NUMBER or type == STP_TypeID::MATRIX_2D;
         STP_TypeID retType = type;
@@ -186,19 +250,72 @@ namespace steppable::parser
         if (operationPerformable)
             return std::make_unique<STP_TypeID>(retType);
 
-        output::error(
-            "parser"s, "Operation {0}({1}) cannot be performed."s, { operatorString, STP_typeNames.at(type) });
+        STP_throwError(*node,
+                       state,
+                       format::format("Operation {0}({1}) cannot be performed."s,
+                                      { operatorString, STP_typeNames.at(type) }));
         return nullptr;
     }
 
     std::any performBinaryOperation(const TSNode* node,
                                     STP_TypeID lhsType,
-                                    std::any value,
-                                    std::string operatorStr,
+                                    const std::any& value,
+                                    const std::string& operatorStr,
                                     STP_TypeID rhsType,
-                                    std::any rhsValue)
+                                    const std::any& rhsValue,
+                                    const STP_InterpState& state,
+                                    STP_MatrixHints* hints)
     {
         std::any returnValueAny;
+
+        // Try the vectorised kernels first, they fall back to `Number` when the values do not fit in `double`.
+        if (lhsType == STP_TypeID::MATRIX_2D and rhsType == STP_TypeID::MATRIX_2D)
+        {
+            const auto& lhsMatrix = std::any_cast<const Matrix&>(value);
+            const auto& rhsMatrix = std::any_cast<const Matrix&>(rhsValue);
+
+            // The matrix product is the only operation on matrices with a result larger than its operands.
+            if (operatorStr == "*" and
+                not state->checkValueSize(sizeof(Number) * lhsMatrix.getRows(), rhsMatrix.getCols()))
+                return Matrix();
+
+            STP_KernelContext context;
+            context.lhsCache = hints != nullptr ? hints->lhsDense : nullptr;
+            context.rhsCache = hints != nullptr ? hints->rhsDense : nullptr;
+            context.allowRounding = state->isFastMath();
+            context.cancel = state->getCancelToken();
+            if (operatorStr == "==" or operatorStr == "!=")
+            {
+                if (const auto equal = STP_applyEqualityKernel(lhsMatrix, rhsMatrix, context))
+                    return Number(*equal == (operatorStr == "=="));
+            }
+            else
+            {
+                std::optional<STP_KernelResult> result;
+                std::optional<bool> hasZero;
+                if (operatorStr == "@")
+                    result = STP_applyDotKernel(lhsMatrix, rhsMatrix, context);
+                else if (operatorStr == "*")
+                    result = STP_applyGemmKernel(lhsMatrix, rhsMatrix, context);
+                else
+                    result = STP_applyMatrixKernel(lhsMatrix, operatorStr, rhsMatrix, &hasZero, context);
+
+                // A cancelled product is incomplete. Stop instead of starting over with `Number`.
+                if (not result and context.cancel.isCancelled())
+                    return {};
+
+                if (result)
+                {
+                    if (hints != nullptr)
+                    {
+                        hints->hasZero = hasZero;
+                        hints->resultDense = std::move(result->dense);
+                    }
+                    return std::move(result->matrix);
+                }
+            }
+        }
+
         if (operatorStr == "+")
         {
             if (lhsType == STP_TypeID::NUMBER and rhsType == STP_TypeID::NUMBER)
@@ -210,7 +327,18 @@ namespace steppable::parser
             else if (lhsType == STP_TypeID::NUMBER and rhsType == STP_TypeID::MATRIX_2D)
                 returnValueAny = Matrix(std::any_cast<Matrix>(rhsValue) + std::any_cast<Number>(value));
             else if (lhsType == STP_TypeID::STRING and rhsType == STP_TypeID::STRING)
-                returnValueAny = std::any_cast<std::string>(value) + std::any_cast<std::string>(rhsValue);
+            {
+                const auto& lhsStr = std::any_cast<const std::string&>(value);
+                const auto& rhsStr = std::any_cast<const std::string&>(rhsValue);
+
+                if (not state->checkValueSize(1, lhsStr.size() + rhsStr.size()))
+                    return std::string();
+
+                std::string result;
+                result.reserve(lhsStr.size() + rhsStr.size());
+                result.append(lhsStr).append(rhsStr);
+                returnValueAny = std::move(result);
+            }
         }
         else if (operatorStr == "-")
         {
@@ -239,14 +367,11 @@ namespace steppable::parser
             else if (lhsType == STP_TypeID::NUMBER and rhsType == STP_TypeID::MATRIX_2D)
                 returnValueAny = Matrix(std::any_cast<Matrix>(rhsValue) * std::any_cast<Number>(value));
             else if (lhsType == STP_TypeID::STRING and rhsType == STP_TypeID::NUMBER)
-            {
-                auto str = std::any_cast<std::string>(value);
-                auto times = std::any_cast<Number>(rhsValue);
-                std::string result;
-                for (Number i = 0; i < times; ++i)
-                    result += str;
-                returnValueAny = result;
-            }
+                returnValueAny = repeatString(
+                    node, std::any_cast<const std::string&>(value), std::any_cast<const Number&>(rhsValue), state);
+            else if (lhsType == STP_TypeID::NUMBER and rhsType == STP_TypeID::STRING)
+                returnValueAny = repeatString(
+                    node, std::any_cast<const std::string&>(rhsValue), std::any_cast<const Number&>(value), state);
         }
         else if (operatorStr == "/")
         {
@@ -370,9 +495,11 @@ namespace steppable::parser
     std::any performUnaryOperation(const TSNode* node,
                                    STP_TypeID type,
                                    const std::string& operatorString,
-                                   const std::any& value)
+                                   const std::any& value,
+                                   const STP_InterpState& state)
     {
-        std::unique_ptr<STP_TypeID> retTypePtr = determineUnaryOperationFeasibility(node, operatorString, type);
+        std::unique_ptr<STP_TypeID> retTypePtr =
+            determineUnaryOperationFeasibility(node, operatorString, type, state);
         if (retTypePtr == nullptr)
             goto fail;
 
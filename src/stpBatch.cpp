@@ -0,0 +1,187 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include "stpInterp/stpBatch.hpp"
+
+#include "output.hpp"
+#include "stpInterp/stpErrors.hpp"
+#include "stpInterp/stpInit.hpp"
+#include "stpInterp/stpProcessor.hpp"
+#include "stpInterp/stpSourceBuffer.hpp"
+#include "stpInterp/stpThreadPool.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include <tree_sitter/api.h>
+}
+
+using namespace std::literals;
+using namespace steppable::utils;
+
+extern "C" TSLanguage* tree_sitter_stp();
+
+namespace steppable::parser
+{
+    namespace
+    {
+        /**
+         * @struct BatchResult
+         * @brief The result of one script in a batch.
+         */
+        struct BatchResult
+        {
+            std::string output; ///< Everything the script printed.
+            std::string error; ///< The error that stopped the script, or empty if it succeeded.
+            bool done = false; ///< Whether the script has finished.
+        };
+
+        /**
+         * @brief Run one script with its own state and parser.
+         *
+         * @param path Path to the script.
+         * @param options Options of the batch run.
+         * @param result Where the output and error of the script are stored.
+         */
+        void runScript(const std::string& path, const STP_BatchOptions& options, BatchResult& result)
+        {
+            const auto source = STP_SourceBuffer::fromFile(path);
+            if (source == nullptr)
+            {
+                result.error = "Unable to open file"s;
+                return;
+            }
+
+            const std::string_view text = source->view();
+            if (const size_t offset = STP_findFirstNonUtf8(text); offset < text.size())
+            {
+                result.error = format::format("Input is not UTF-8 at offset {0}"s, { std::to_string(offset) });
+                return;
+            }
+
+            // Errors are recorded on the state instead of exiting, so that other scripts keep running.
+            const STP_InterpState state = STP_createState();
+            state->setEmbedded();
+            state->setFile(path);
+            if (options.fastMath)
+                state->setFastMath();
+            state->setLimits(options.limits);
+            state->getOutput().captureTo(&result.output);
+
+            TSParser* parser = ts_parser_new();
+            ts_parser_set_language(parser, tree_sitter_stp());
+            TSTree* tree = ts_parser_parse_string(parser, nullptr, text.data(), static_cast<uint32_t>(text.size()));
+            try
+            {
+                const TSNode rootNode = ts_tree_root_node(tree);
+                state->setChunk(source);
+                state->startEvaluation();
+                if (not STP_checkRecursiveNodeSanity(rootNode, state))
+                    STP_processChunkChild(rootNode, state);
+                result.error = state->getError();
+            }
+            catch (const std::exception& exception)
+            {
+                result.error = exception.what();
+            }
+
+            state->getOutput().flush();
+            ts_tree_delete(tree);
+            ts_parser_delete(parser);
+        }
+    } // namespace
+
+    bool STP_readManifest(const std::string& manifestPath, std::vector<std::string>& paths)
+    {
+        std::ifstream manifest(manifestPath);
+        if (not manifest)
+            return false;
+
+        std::string line;
+        while (std::getline(manifest, line))
+        {
+            line = stringUtils::bothEndsReplace(line, ' ');
+            if (not line.empty() and line.back() == '\r')
+                line.pop_back();
+            if (line.empty() or line.front() == '#')
+                continue;
+            paths.emplace_back(std::move(line));
+        }
+        return true;
+    }
+
+    int STP_runBatch(const std::vector<std::string>& paths, const STP_BatchOptions& options)
+    {
+        std::vector<BatchResult> results(paths.size());
+        std::mutex resultsMutex;
+        size_t nextToWrite = 0;
+        int ret = 0;
+
+        const auto runScripts = [&](const size_t begin, const size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                BatchResult result;
+                runScript(paths[i], options, result);
+
+                // Write out every finished script that all scripts before it have finished as well.
+                std::lock_guard lock(resultsMutex);
+                results[i] = std::move(result);
+                results[i].done = true;
+                for (; nextToWrite < results.size() and results[nextToWrite].done; nextToWrite++)
+                {
+                    auto& finished = results[nextToWrite];
+                    fwrite(finished.output.data(), 1, finished.output.size(), stdout);
+                    fflush(stdout);
+                    if (not finished.error.empty())
+                    {
+                        output::error("parser"s, "{0}: {1}"s, { paths[nextToWrite], finished.error });
+                        ret = 1;
+                    }
+
+                    // Free the output as soon as it is written.
+                    finished.output = std::string();
+                }
+            }
+        };
+
+        const size_t jobs = options.jobs == 0 ? std::max<size_t>(1, std::thread::hardware_concurrency()) : options.jobs;
+        if (jobs == 1)
+            runScripts(0, paths.size());
+        else
+        {
+            // The calling thread runs scripts as well, so the pool has one thread less than the number of jobs.
+            STP_ThreadPool pool(jobs - 1);
+            pool.parallelFor(0, paths.size(), 1, runScripts);
+        }
+
+        return ret;
+    }
+} // namespace steppable::parser
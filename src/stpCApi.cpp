@@ -0,0 +1,150 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include "stpInterp/stpCApi.h"
+
+#include "stpInterp/stpErrors.hpp"
+#include "stpInterp/stpInit.hpp"
+#include "stpInterp/stpProcessor.hpp"
+#include "stpInterp/stpSourceBuffer.hpp"
+
+#include <exception>
+#include <memory>
+#include <string>
+
+extern "C" {
+#include <tree_sitter/api.h>
+}
+
+using namespace std::literals;
+using namespace steppable;
+using namespace steppable::parser;
+
+extern "C" TSLanguage* tree_sitter_stp();
+
+/**
+ * @brief An interpreter context of the C interface.
+ */
+struct STP_Context
+{
+    std::string result; ///< Output of the last evaluation. Declared first, so that it outlives the state.
+    std::string error; ///< Error of the last evaluation.
+    STP_InterpState state; ///< The state of the interpreter. Its output is captured into `result`.
+    TSParser* parser = nullptr; ///< The parser, reused for every evaluation.
+
+    STP_Context() : state(STP_createState()), parser(ts_parser_new())
+    {
+        ts_parser_set_language(parser, tree_sitter_stp());
+        state->setEmbedded();
+        state->setFile("<embedded>");
+        state->getOutput().captureTo(&result);
+    }
+
+    ~STP_Context()
+    {
+        // Flush into `result` now, so that the state never writes to it while it is destroyed, or after that.
+        state->getOutput().captureTo(nullptr);
+        ts_parser_delete(parser);
+    }
+
+    STP_Context(const STP_Context&) = delete;
+    STP_Context& operator=(const STP_Context&) = delete;
+    STP_Context(STP_Context&&) = delete;
+    STP_Context& operator=(STP_Context&&) = delete;
+};
+
+extern "C" {
+STP_Context* STP_createContext(void)
+{
+    try
+    {
+        return new STP_Context();
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+int STP_evalString(STP_Context* context, const char* source, const size_t length)
+{
+    if (context == nullptr or source == nullptr)
+        return STP_EVAL_ERROR;
+
+    const auto& state = context->state;
+    context->result.clear();
+    context->error.clear();
+    state->clearError();
+    state->setExecState(STP_ExecState::NORMAL);
+
+    TSTree* tree = nullptr;
+    state->startEvaluation();
+    try
+    {
+        const auto buffer = std::make_shared<const STP_SourceBuffer>(std::string(source, length));
+        const std::string_view text = buffer->view();
+
+        tree = ts_parser_parse_string(context->parser, nullptr, text.data(), static_cast<uint32_t>(text.size()));
+        const TSNode rootNode = ts_tree_root_node(tree);
+        state->setChunk(buffer);
+        if (not STP_checkRecursiveNodeSanity(rootNode, state))
+            STP_processChunkChild(rootNode, state);
+    }
+    catch (const std::exception& exception)
+    {
+        // Exceptions must not cross the C boundary. An error reported before the exception is kept, as it is the
+        // cause.
+        state->setError(exception.what());
+    }
+    catch (...)
+    {
+        state->setError("Unknown error"s);
+    }
+    context->error = state->getError();
+
+    state->getOutput().flush();
+
+    // Functions declared by the source own a copy of the tree, so that later calls on the context can use them.
+    if (tree != nullptr)
+        ts_tree_delete(tree);
+
+    if (state->getLimitHit() != STP_LimitKind::NONE)
+        return STP_EVAL_LIMIT;
+    return context->error.empty() ? STP_EVAL_OK : STP_EVAL_ERROR;
+}
+
+void STP_setLimits(STP_Context* context,
+                   const unsigned long long maxSteps,
+                   const unsigned long long timeoutMs,
+                   const size_t maxValueBytes)
+{
+    if (context == nullptr)
+        return;
+    context->state->setLimits({ .maxSteps = maxSteps, .timeoutMs = timeoutMs, .maxValueBytes = maxValueBytes });
+}
+
+const char* STP_getResult(const STP_Context* context) { return context == nullptr ? "" : context->result.c_str(); }
+
+const char* STP_getError(const STP_Context* context) { return context == nullptr ? "" : context->error.c_str(); }
+
+void STP_destroyContext(STP_Context* context) { delete context; }
+}
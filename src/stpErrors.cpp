@@ -27,6 +27,8 @@
 #include "util.hpp"
 
 #include <cmath>
+#include <string>
+#include <vector>
 
 using namespace std::literals;
 
@@ -34,6 +36,37 @@ namespace steppable::parser
 {
     using namespace steppable;
 
+    namespace
+    {
+        /**
+         * @brief Print a line of an error report, through the writer of the output sink if it has one.
+         *
+         * @param sink The output sink of the state.
+         * @param isError Whether the line is the error message, or information about it.
+         * @param message The format string of the line.
+         * @param args The arguments of the format string.
+         */
+        void reportLine(STP_OutputSink& sink,
+                        const bool isError,
+                        const std::string& message,
+                        const std::vector<std::string>& args = {})
+        {
+            if (sink.hasWriter())
+            {
+                const std::string line = format::format(message, args);
+                sink.writeLine(isError ? "ERROR: "s + line : line);
+                sink.flush();
+                return;
+            }
+
+            sink.flush();
+            if (isError)
+                output::error("parser"s, message, args);
+            else
+                output::info("parser"s, message, args);
+        }
+    } // namespace
+
     bool STP_checkRecursiveNodeSanity(const TSNode& node, const STP_InterpState& state)
     {
         if (ts_node_is_null(node))
@@ -57,18 +90,34 @@ namespace steppable::parser
 
     void STP_throwError(const TSNode& node, const STP_InterpState& state, const std::string& reason)
     {
-        output::error("parser"s, reason);
+        state->getOutput().flush();
 
         auto [startRow, startCol] = ts_node_start_point(node);
         auto [endRow, endCol] = ts_node_end_point(node);
 
-        output::error("parser"s,
-                      "At {0} : Ln {1}, Col {2}"s,
-                      {
-                          state->getFile(),
-                          std::to_string(startRow + 1),
-                          std::to_string(startCol),
-                      });
+        if (state->isEmbedded())
+        {
+            state->setError(format::format("{0} (at {1} : Ln {2}, Col {3})"s,
+                                           {
+                                               reason,
+                                               state->getFile(),
+                                               std::to_string(startRow + 1),
+                                               std::to_string(startCol),
+                                           }));
+            state->setExecState(STP_ExecState::REQUEST_STOP);
+            return;
+        }
+
+        STP_OutputSink& sink = state->getOutput();
+        reportLine(sink, true, reason);
+        reportLine(sink,
+                   true,
+                   "At {0} : Ln {1}, Col {2}"s,
+                   {
+                       state->getFile(),
+                       std::to_string(startRow + 1),
+                       std::to_string(startCol),
+                   });
         std::string errorChunk = state->getChunk();
         auto lines = stringUtils::split(errorChunk, '\n');
         lines.erase(lines.begin(), lines.begin() + startRow);
@@ -83,19 +132,34 @@ namespace steppable::parser
             const auto& line = lines.at(i);
             std::string lineNo = stringUtils::lPad(std::to_string(startRow + i + 1), padding);
             std::string indicators = std::string(startCol, ' ') + std::string(endCol - startCol, '~');
-            output::info("parser"s,
-                         "{0}  | {1}"s,
-                         {
-                             lineNo,
-                             line,
-                         });
-            output::info("parser"s, "{0}  | {1}"s, { std::string(lineNo.length(), ' '), indicators });
+            reportLine(sink,
+                       false,
+                       "{0}  | {1}"s,
+                       {
+                           lineNo,
+                           line,
+                       });
+            reportLine(sink, false, "{0}  | {1}"s, { std::string(lineNo.length(), ' '), indicators });
         }
 
         if (not state->isInteractive())
             utils::programSafeExit(1);
     }
 
+    void STP_reportError(STP_OutputSink& sink, const std::string& message) { reportLine(sink, true, message); }
+
+    void STP_rethrowChildError(const TSNode& node, const STP_InterpState& state, const std::string& error)
+    {
+        if (not state->isEmbedded())
+        {
+            STP_throwError(node, state, error);
+            return;
+        }
+
+        state->setError(error);
+        state->setExecState(STP_ExecState::REQUEST_STOP);
+    }
+
     void STP_throwSyntaxError(const TSNode& node, const STP_InterpState& state)
     {
         STP_throwError(node, state, "Syntax error"s);
@@ -0,0 +1,129 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include "stpInterp/stpEvalWorker.hpp"
+
+#include "stpInterp/stpErrors.hpp"
+#include "stpInterp/stpInterrupt.hpp"
+#include "stpInterp/stpProcessor.hpp"
+
+#include <utility>
+
+namespace steppable::parser
+{
+    STP_EvalWorker::STP_EvalWorker(STP_InterpState state, const TSLanguage* language) :
+        state(std::move(state)), parser(ts_parser_new())
+    {
+        ts_parser_set_language(parser, language);
+        thread = std::thread([this] { workerLoop(); });
+    }
+
+    STP_EvalWorker::~STP_EvalWorker()
+    {
+        {
+            std::lock_guard lock(mutex);
+            pending.clear();
+            stopping = true;
+        }
+        changed.notify_all();
+        if (thread.joinable())
+            thread.join();
+        ts_parser_delete(parser);
+    }
+
+    void STP_EvalWorker::submit(std::string source)
+    {
+        {
+            std::lock_guard lock(mutex);
+            pending.emplace_back(std::move(source));
+        }
+        changed.notify_all();
+    }
+
+    void STP_EvalWorker::cancel()
+    {
+        std::lock_guard lock(mutex);
+        pending.clear();
+
+        // Not through the exec state, which the evaluation itself resets, e.g., after `break` or `ret`. Only this
+        // evaluation and its child states stop, tasks spawned by earlier ones keep running.
+        if (evaluating)
+            state->requestCancel();
+    }
+
+    void STP_EvalWorker::wait()
+    {
+        std::unique_lock lock(mutex);
+        changed.wait(lock, [this] { return stopping or (pending.empty() and not evaluating); });
+    }
+
+    bool STP_EvalWorker::isBusy()
+    {
+        std::lock_guard lock(mutex);
+        return evaluating or not pending.empty();
+    }
+
+    void STP_EvalWorker::workerLoop()
+    {
+        while (true)
+        {
+            std::string source;
+            {
+                std::unique_lock lock(mutex);
+                changed.wait(lock, [this] { return stopping or not pending.empty(); });
+                if (stopping)
+                    return;
+                source = std::move(pending.front());
+                pending.pop_front();
+                evaluating = true;
+
+                // Start here, so that a cancel cannot be lost between taking the source and starting it, and does
+                // not race with the new stop flag. An earlier [Ctrl-C] does not stop this evaluation.
+                STP_clearInterrupt();
+                if (state->getExecState() != STP_ExecState::EXIT)
+                    state->setExecState(STP_ExecState::NORMAL);
+                state->startEvaluation();
+            }
+
+            evaluate(source);
+
+            {
+                std::lock_guard lock(mutex);
+                evaluating = false;
+            }
+            if (onEvaluated)
+                onEvaluated();
+            changed.notify_all();
+        }
+    }
+
+    void STP_EvalWorker::evaluate(const std::string& source)
+    {
+        TSTree* tree = ts_parser_parse_string(parser, nullptr, source.data(), static_cast<uint32_t>(source.size()));
+        const TSNode rootNode = ts_tree_root_node(tree);
+        state->setChunk(source, 0, source.size());
+        if (not STP_checkRecursiveNodeSanity(rootNode, state))
+            STP_processChunkChild(rootNode, state);
+        state->getOutput().flush();
+        ts_tree_delete(tree);
+    }
+} // namespace steppable::parser
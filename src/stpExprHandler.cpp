@@ -26,11 +26,14 @@
 #include "steppable/stpArgSpace.hpp"
 #include "steppable/stpTypeName.hpp"
 #include "stpInterp/stpBetterTS.hpp"
+#include "stpInterp/stpFastMath.hpp"
 #include "stpInterp/stpInit.hpp"
 #include "stpInterp/stpStore.hpp"
 
 #include <cassert>
 #include <cstdint>
+#include <optional>
+#include <utility>
 
 using namespace std::literals;
 
@@ -41,9 +44,6 @@ namespace steppable::parser
                              const bool printResult,
                              const std::string& exprName)
     {
-        if (state->getExecState() == STP_ExecState::REQUEST_STOP)
-            return STP_Value(STP_TypeID::NONE);
-
         assert(exprNode != nullptr);
         std::string exprType = ts_node_type(*exprNode);
 
@@ -53,7 +53,14 @@ namespace steppable::parser
         {
             // Number
             std::string data = state->getChunk(exprNode);
-            retVal = STP_Value(STP_TypeID::NUMBER, Number(data));
+            std::optional<STP_FastNumber> fastNumber;
+            if (state->isFastMath())
+                fastNumber = STP_parseFastNumber(data);
+
+            if (fastNumber)
+                retVal = STP_Value(*fastNumber);
+            else
+                retVal = STP_Value(STP_TypeID::NUMBER, Number(data));
         }
         if (exprType == "percentage")
         {
@@ -78,7 +85,7 @@ namespace steppable::parser
             if (childNodeType == "identifier")
             {
                 std::string identifierName = state->getChunk(&nameNode);
-                retVal = state->getCurrentScope()->getVariable(&nameNode, identifierName);
+                retVal = state->getCurrentScope()->getVariable(&nameNode, identifierName, state);
             }
         }
         if (exprType == "function_call")
@@ -108,7 +115,7 @@ namespace steppable::parser
                 goto end;
             }
 
-            retVal = lhs.applyBinaryOperator(exprNode, operatorType, rhs);
+            retVal = lhs.applyBinaryOperator(exprNode, operatorType, rhs, state);
         }
         if (exprType == "unary_expression")
         {
@@ -117,7 +124,7 @@ namespace steppable::parser
             std::string operandType = ts_node_type(operandNode);
 
             STP_Value childVal = STP_handleExpr(&child, state);
-            retVal = childVal.applyUnaryOperator(exprNode, operandType);
+            retVal = childVal.applyUnaryOperator(exprNode, operandType, state);
         }
         if (exprType == "bracketed_expr")
         {
@@ -130,8 +137,11 @@ namespace steppable::parser
             retVal = STP_handleSuffixExpr(exprNode, state);
 
     end:
-        if (printResult and retVal.typeID != STP_TypeID::NONE)
-            std::cout << retVal.present(exprName) << '\n';
+        // The value is still rendered into a string by `present()` of the core library, which owns the format of
+        // numbers and matrices. The sink takes the rendered text without a further copy when it exceeds the buffer.
+        // Values of interrupted expressions may be incomplete, e.g., a product with some rows left out.
+        if (printResult and retVal.typeID != STP_TypeID::NONE and not state->shouldStop())
+            state->getOutput().writeLine(retVal.presentMaterialized(exprName));
 
         return retVal;
     }
@@ -147,8 +157,8 @@ namespace steppable::parser
             for (uint32_t i = 0; i < posArgumentsCount; i++)
             {
                 TSNode argNode = ts_node_named_child(posArgumentsNode, i);
-                STP_Value res = STP_handleExpr(&argNode, state);
-                STP_Argument argument("", res.data, res.typeID);
+                STP_Value res = STP_handleExpr(&argNode, state).materialized();
+                STP_Argument argument("", std::move(res.data), res.typeID);
                 fnArgsVec.emplace_back(argument);
             }
 
@@ -164,8 +174,8 @@ namespace steppable::parser
 
                     std::string argName = state->getChunk(&argNameNode);
 
-                    STP_Value res = STP_handleExpr(&argExprNode, state);
-                    STP_Argument argument(argName, res.data, res.typeID);
+                    STP_Value res = STP_handleExpr(&argExprNode, state).materialized();
+                    STP_Argument argument(argName, std::move(res.data), res.typeID);
                     fnArgsVec.emplace_back(argument);
                 }
             }
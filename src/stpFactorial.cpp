@@ -0,0 +1,123 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include "stpInterp/stpFactorial.hpp"
+
+#include "fn/calc.hpp"
+#include "stpInterp/stpFastMath.hpp"
+
+#include <array>
+#include <optional>
+#include <string>
+
+namespace steppable::parser
+{
+    namespace
+    {
+        /// 20! is the largest factorial that fits into `uint64_t`.
+        constexpr uint64_t MAX_TABLE_N = 20;
+
+        constexpr std::array<uint64_t, MAX_TABLE_N + 1> FACTORIAL_TABLE = [] {
+            std::array<uint64_t, MAX_TABLE_N + 1> table{};
+            table[0] = 1;
+            for (uint64_t i = 1; i <= MAX_TABLE_N; i++)
+                table[i] = table[i - 1] * i;
+            return table;
+        }();
+
+        /// Ranges shorter than this are multiplied with machine integers as far as possible.
+        constexpr uint64_t LEAF_SIZE = 16;
+
+        Number toNumber(const uint64_t value) { return Number(std::to_string(value)); }
+
+        /**
+         * @brief Product of all integers in `[lo, hi]`, splitting the range in halves so that operands stay balanced.
+         * @note Leaves are skipped once `cancel` fires, so check it before using the result.
+         */
+        Number productRange(const uint64_t lo, const uint64_t hi, const STP_CancelToken& cancel)
+        {
+            if (lo > hi)
+                return toNumber(1);
+
+            if (hi - lo < LEAF_SIZE)
+            {
+                // Safepoint
+                if (cancel.isCancelled())
+                    return toNumber(1);
+
+                Number result = toNumber(1);
+                uint64_t partial = 1;
+                for (uint64_t i = lo; i <= hi; i++)
+                {
+                    uint64_t next = 0;
+#if defined(__GNUC__) || defined(__clang__)
+                    const bool overflow = __builtin_mul_overflow(partial, i, &next);
+#else
+                    const bool overflow = partial > UINT64_MAX / i;
+                    next = partial * i;
+#endif
+                    if (overflow)
+                    {
+                        result = result * toNumber(partial);
+                        partial = i;
+                    }
+                    else
+                        partial = next;
+                }
+                return result * toNumber(partial);
+            }
+
+            const uint64_t mid = lo + ((hi - lo) / 2);
+            return productRange(lo, mid, cancel) * productRange(mid + 1, hi, cancel);
+        }
+    } // namespace
+
+    std::optional<Number> STP_FactorialEngine::operator()(const Number& number)
+    {
+        const auto integer = STP_numberToInteger(number);
+        if (not integer or *integer < 0)
+            return calc::factorial(number.present(), 0);
+
+        const auto n = static_cast<uint64_t>(*integer);
+        if (n <= MAX_TABLE_N)
+            return toNumber(FACTORIAL_TABLE[n]);
+
+        if (const auto it = memo.find(n); it != memo.end())
+            return it->second;
+
+        // Continue from the largest factorial known so far.
+        uint64_t start = MAX_TABLE_N;
+        Number base = toNumber(FACTORIAL_TABLE[MAX_TABLE_N]);
+        if (auto it = memo.lower_bound(n); it != memo.begin())
+        {
+            --it;
+            start = it->first;
+            base = it->second;
+        }
+
+        Number result = base * productRange(start + 1, n, cancel);
+        if (cancel.isCancelled())
+            return std::nullopt;
+        memo.emplace(n, result);
+        return result;
+    }
+} // namespace steppable::parser
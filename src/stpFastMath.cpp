@@ -0,0 +1,342 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include "stpInterp/stpFastMath.hpp"
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <limits>
+
+using namespace std::literals;
+
+namespace steppable::parser
+{
+    namespace
+    {
+        /// Maximum number of significant digits that a `double` holds without losing precision.
+        constexpr size_t MAX_REAL_DIGITS = std::numeric_limits<double>::digits10;
+
+        /// Integers with an absolute value up to this are exactly representable as `double`.
+        constexpr int64_t MAX_EXACT_INTEGER = int64_t{ 1 } << std::numeric_limits<double>::digits;
+
+        bool checkedAdd(const int64_t a, const int64_t b, int64_t& result)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return not __builtin_add_overflow(a, b, &result);
+#else
+            if ((b > 0 and a > std::numeric_limits<int64_t>::max() - b) or
+                (b < 0 and a < std::numeric_limits<int64_t>::min() - b))
+                return false;
+            result = a + b;
+            return true;
+#endif
+        }
+
+        bool checkedSub(const int64_t a, const int64_t b, int64_t& result)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return not __builtin_sub_overflow(a, b, &result);
+#else
+            if ((b < 0 and a > std::numeric_limits<int64_t>::max() + b) or
+                (b > 0 and a < std::numeric_limits<int64_t>::min() + b))
+                return false;
+            result = a - b;
+            return true;
+#endif
+        }
+
+        bool checkedMul(const int64_t a, const int64_t b, int64_t& result)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return not __builtin_mul_overflow(a, b, &result);
+#else
+            if (a == 0 or b == 0)
+            {
+                result = 0;
+                return true;
+            }
+            if ((a == -1 and b == std::numeric_limits<int64_t>::min()) or
+                (b == -1 and a == std::numeric_limits<int64_t>::min()))
+                return false;
+            const int64_t product = a * b;
+            if (product / b != a)
+                return false;
+            result = product;
+            return true;
+#endif
+        }
+
+        bool checkedPow(int64_t base, int64_t exponent, int64_t& result)
+        {
+            int64_t acc = 1;
+            while (exponent > 0)
+            {
+                if ((exponent & 1) != 0 and not checkedMul(acc, base, acc))
+                    return false;
+                exponent >>= 1;
+                if (exponent > 0 and not checkedMul(base, base, base))
+                    return false;
+            }
+            result = acc;
+            return true;
+        }
+
+        STP_FastNumber makeInteger(const int64_t value)
+        {
+            return { .kind = STP_FastNumber::Kind::INTEGER, .integer = value, .real = 0.0 };
+        }
+
+        STP_FastNumber makeReal(const double value)
+        {
+            return { .kind = STP_FastNumber::Kind::REAL, .integer = 0, .real = value };
+        }
+
+        /// Compare two fast numbers. Returns false if the comparison cannot be done exactly.
+        bool compare(const STP_FastNumber& lhs, const STP_FastNumber& rhs, int& ordering)
+        {
+            if (lhs.kind == STP_FastNumber::Kind::INTEGER and rhs.kind == STP_FastNumber::Kind::INTEGER)
+            {
+                ordering = (lhs.integer > rhs.integer) - (lhs.integer < rhs.integer);
+                return true;
+            }
+
+            // Integers beyond 2^53 cannot be converted to `double` exactly.
+            for (const auto* value : { &lhs, &rhs })
+                if (value->kind == STP_FastNumber::Kind::INTEGER and
+                    (value->integer > MAX_EXACT_INTEGER or value->integer < -MAX_EXACT_INTEGER))
+                    return false;
+
+            const double a = lhs.asReal();
+            const double b = rhs.asReal();
+            ordering = (a > b) - (a < b);
+            return true;
+        }
+
+        bool applyIntegerOperator(const int64_t a, const std::string& operatorStr, const int64_t b, STP_FastNumber& result)
+        {
+            int64_t value = 0;
+            if (operatorStr == "+")
+            {
+                if (not checkedAdd(a, b, value))
+                    return false;
+            }
+            else if (operatorStr == "-")
+            {
+                if (not checkedSub(a, b, value))
+                    return false;
+            }
+            else if (operatorStr == "*")
+            {
+                if (not checkedMul(a, b, value))
+                    return false;
+            }
+            else if (operatorStr == "/")
+            {
+                if (b == 0 or (a == std::numeric_limits<int64_t>::min() and b == -1))
+                    return false;
+                if (a % b != 0)
+                {
+                    result = makeReal(static_cast<double>(a) / static_cast<double>(b));
+                    return std::isfinite(result.real);
+                }
+                value = a / b;
+            }
+            else if (operatorStr == "mod")
+            {
+                // Leave the sign conventions of negative operands to `Number`.
+                if (a < 0 or b <= 0)
+                    return false;
+                value = a % b;
+            }
+            else if (operatorStr == "^")
+            {
+                if (b < 0 or not checkedPow(a, b, value))
+                    return false;
+            }
+            else
+                return false;
+
+            result = makeInteger(value);
+            return true;
+        }
+
+        bool applyRealOperator(const double a, const std::string& operatorStr, const double b, STP_FastNumber& result)
+        {
+            double value = 0.0;
+            if (operatorStr == "+")
+                value = a + b;
+            else if (operatorStr == "-")
+                value = a - b;
+            else if (operatorStr == "*")
+                value = a * b;
+            else if (operatorStr == "/")
+            {
+                if (b == 0.0)
+                    return false;
+                value = a / b;
+            }
+            else if (operatorStr == "^")
+                value = std::pow(a, b);
+            else
+                return false;
+
+            // Overflow, or a result that cannot be represented. Promote to `Number`.
+            if (not std::isfinite(value))
+                return false;
+            result = makeReal(value);
+            return true;
+        }
+    } // namespace
+
+    std::optional<STP_FastNumber> STP_parseFastNumber(const std::string_view literal)
+    {
+        const char* first = literal.data();
+        const char* last = literal.data() + literal.size();
+
+        if (literal.find('.') == std::string_view::npos)
+        {
+            int64_t value = 0;
+            if (const auto [ptr, ec] = std::from_chars(first, last, value); ec != std::errc{} or ptr != last)
+                return std::nullopt;
+            return makeInteger(value);
+        }
+
+        // Keep the precision of literals with more digits than a `double` can hold.
+        if (const size_t firstDigit = literal.find_first_not_of("0."); firstDigit != std::string_view::npos)
+        {
+            const std::string_view digits = literal.substr(firstDigit);
+            const size_t significantDigits = digits.size() - (digits.find('.') != std::string_view::npos ? 1 : 0);
+            if (significantDigits > MAX_REAL_DIGITS)
+                return std::nullopt;
+        }
+
+        double value = 0.0;
+        if (const auto [ptr, ec] = std::from_chars(first, last, value); ec != std::errc{} or ptr != last)
+            return std::nullopt;
+        return makeReal(value);
+    }
+
+    bool STP_applyFastBinaryOperator(const STP_FastNumber& lhs,
+                                     const std::string& operatorStr,
+                                     const STP_FastNumber& rhs,
+                                     STP_FastNumber& result)
+    {
+        if (lhs.kind == STP_FastNumber::Kind::NONE or rhs.kind == STP_FastNumber::Kind::NONE)
+            return false;
+
+        if (operatorStr == "==" or operatorStr == "!=" or operatorStr == ">" or operatorStr == "<" or
+            operatorStr == ">=" or operatorStr == "<=")
+        {
+            int ordering = 0;
+            if (not compare(lhs, rhs, ordering))
+                return false;
+
+            bool value = false;
+            if (operatorStr == "==")
+                value = ordering == 0;
+            else if (operatorStr == "!=")
+                value = ordering != 0;
+            else if (operatorStr == ">")
+                value = ordering > 0;
+            else if (operatorStr == "<")
+                value = ordering < 0;
+            else if (operatorStr == ">=")
+                value = ordering >= 0;
+            else
+                value = ordering <= 0;
+
+            result = makeInteger(value ? 1 : 0);
+            return true;
+        }
+
+        if (lhs.kind == STP_FastNumber::Kind::INTEGER and rhs.kind == STP_FastNumber::Kind::INTEGER)
+            return applyIntegerOperator(lhs.integer, operatorStr, rhs.integer, result);
+        return applyRealOperator(lhs.asReal(), operatorStr, rhs.asReal(), result);
+    }
+
+    bool STP_applyFastUnaryOperator(const std::string& operatorStr, const STP_FastNumber& value, STP_FastNumber& result)
+    {
+        if (value.kind == STP_FastNumber::Kind::NONE)
+            return false;
+
+        if (operatorStr == "+")
+        {
+            result = value;
+            return true;
+        }
+        if (operatorStr == "-")
+        {
+            if (value.kind == STP_FastNumber::Kind::REAL)
+            {
+                result = makeReal(-value.real);
+                return true;
+            }
+            if (value.integer == std::numeric_limits<int64_t>::min())
+                return false;
+            result = makeInteger(-value.integer);
+            return true;
+        }
+        if (operatorStr == "~")
+        {
+            result = makeInteger(value.asReal() == 0.0 ? 1 : 0);
+            return true;
+        }
+        return false;
+    }
+
+    std::string STP_presentFastNumber(const STP_FastNumber& value)
+    {
+        if (value.kind == STP_FastNumber::Kind::INTEGER)
+            return std::to_string(value.integer);
+
+        // Large enough for any finite `double` in fixed notation.
+        std::array<char, 512> buffer{};
+        const auto [ptr, ec] =
+            std::to_chars(buffer.data(), buffer.data() + buffer.size(), value.real, std::chars_format::fixed);
+        if (ec != std::errc{})
+            return std::to_string(value.real);
+        return { buffer.data(), ptr };
+    }
+
+    std::optional<int64_t> STP_numberToInteger(const Number& number)
+    {
+        const std::string str = number.present();
+        std::string_view digits = str;
+
+        // Accept trailing zeros after the decimal point, e.g., `3.000`.
+        if (const size_t point = digits.find('.'); point != std::string_view::npos)
+        {
+            if (digits.find_first_not_of('0', point + 1) != std::string_view::npos)
+                return std::nullopt;
+            digits = digits.substr(0, point);
+        }
+
+        int64_t value = 0;
+        const char* last = digits.data() + digits.size();
+        if (const auto [ptr, ec] = std::from_chars(digits.data(), last, value); ec != std::errc{} or ptr != last)
+            return std::nullopt;
+        return value;
+    }
+
+    Number STP_fastToNumber(const STP_FastNumber& value) { return Number(STP_presentFastNumber(value)); }
+} // namespace steppable::parser
@@ -0,0 +1,65 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include "stpInterp/stpFuture.hpp"
+
+#include "stpInterp/stpErrors.hpp"
+
+#include <chrono>
+#include <future>
+
+namespace steppable::parser
+{
+    STP_Value STP_resolveFuture(const STP_Value& value, const TSNode* node, const STP_InterpState& state)
+    {
+        if (not value.isFuture())
+            return value;
+
+        // The task stops by itself if it belongs to the evaluation that is stopping.
+        while (value.future->result.wait_for(std::chrono::milliseconds(STP_FUTURE_POLL_INTERVAL_MS)) !=
+               std::future_status::ready)
+            if (state->shouldStop())
+                return STP_Value(STP_TypeID::NONE);
+
+        const STP_FutureResult& result = value.future->result.get();
+
+        bool firstResolution = false;
+        {
+            std::lock_guard lock(value.future->mutex);
+            firstResolution = not value.future->reported;
+            value.future->reported = true;
+        }
+
+        if (firstResolution)
+        {
+            state->getOutput().write(result.output);
+            if (result.limitHit != STP_LimitKind::NONE)
+                state->hitLimit(result.limitHit);
+            else if (not result.error.empty())
+                STP_rethrowChildError(*node, state, result.error);
+        }
+
+        if (result.limitHit != STP_LimitKind::NONE or not result.error.empty())
+            return STP_Value(STP_TypeID::NONE);
+        return result.value;
+    }
+} // namespace steppable::parser
@@ -0,0 +1,135 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include "stpInterp/stpIncrementalParse.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+namespace steppable::parser
+{
+    namespace
+    {
+        /**
+         * @brief Find the row and byte column of an offset in a text.
+         *
+         * @param text The text.
+         * @param offset The byte offset.
+         * @return The point of the offset.
+         */
+        TSPoint pointAt(const std::string_view text, const size_t offset)
+        {
+            const std::string_view before = text.substr(0, offset);
+            const auto row = static_cast<uint32_t>(std::ranges::count(before, '\n'));
+            const size_t lineStart = before.rfind('\n');
+            const size_t column = lineStart == std::string_view::npos ? offset : offset - lineStart - 1;
+            return { .row = row, .column = static_cast<uint32_t>(column) };
+        }
+    } // namespace
+
+    TSInputEdit STP_findEdit(const std::string_view oldText, const std::string_view newText)
+    {
+        const size_t maxCommon = std::min(oldText.size(), newText.size());
+
+        size_t prefix = 0;
+        while (prefix < maxCommon and oldText[prefix] == newText[prefix])
+            prefix++;
+
+        size_t suffix = 0;
+        while (suffix < maxCommon - prefix and
+               oldText[oldText.size() - suffix - 1] == newText[newText.size() - suffix - 1])
+            suffix++;
+
+        const size_t oldEnd = oldText.size() - suffix;
+        const size_t newEnd = newText.size() - suffix;
+        return {
+            .start_byte = static_cast<uint32_t>(prefix),
+            .old_end_byte = static_cast<uint32_t>(oldEnd),
+            .new_end_byte = static_cast<uint32_t>(newEnd),
+            .start_point = pointAt(newText, prefix),
+            .old_end_point = pointAt(oldText, oldEnd),
+            .new_end_point = pointAt(newText, newEnd),
+        };
+    }
+
+    STP_IncrementalParser::~STP_IncrementalParser() { reset(); }
+
+    TSTree* STP_IncrementalParser::parse(const std::string_view newText)
+    {
+        if (tree != nullptr and newText == text)
+        {
+            changedRanges.clear();
+            return tree;
+        }
+
+        TSInputEdit edit{};
+        if (tree != nullptr)
+        {
+            edit = STP_findEdit(text, newText);
+            ts_tree_edit(tree, &edit);
+        }
+
+        TSTree* newTree =
+            ts_parser_parse_string(parser, tree, newText.data(), static_cast<uint32_t>(newText.size()));
+
+        changedRanges.clear();
+        if (tree != nullptr)
+        {
+            uint32_t rangeCount = 0;
+            TSRange* ranges = ts_tree_get_changed_ranges(tree, newTree, &rangeCount);
+            changedRanges.assign(ranges, ranges + rangeCount);
+            free(ranges); // NOLINT(*-no-malloc)
+            ts_tree_delete(tree);
+
+            changedRanges.push_back({
+                .start_point = edit.start_point,
+                .end_point = edit.new_end_point,
+                .start_byte = edit.start_byte,
+                .end_byte = edit.new_end_byte,
+            });
+        }
+        else
+        {
+            const TSNode rootNode = ts_tree_root_node(newTree);
+            changedRanges.push_back({
+                .start_point = ts_node_start_point(rootNode),
+                .end_point = ts_node_end_point(rootNode),
+                .start_byte = 0,
+                .end_byte = static_cast<uint32_t>(newText.size()),
+            });
+        }
+
+        tree = newTree;
+        text = newText;
+        return tree;
+    }
+
+    void STP_IncrementalParser::reset()
+    {
+        if (tree != nullptr)
+            ts_tree_delete(tree);
+        tree = nullptr;
+        text.clear();
+        changedRanges.clear();
+    }
+} // namespace steppable::parser
@@ -32,12 +32,53 @@ using namespace std::literals;
 
 namespace steppable::parser
 {
-    const auto _storage = std::make_shared<STP_InterpStoreLocal>();
+    namespace
+    {
+        /**
+         * @brief Define the built-in constants in the global scope of a state.
+         *
+         * @param state The state to initialize.
+         */
+        void initState(const STP_InterpState& state)
+        {
+            state->getGlobalScope()->addVariable("pi", STP_Value(STP_TypeID::NUMBER, Number(constants::PI), true));
+            state->getGlobalScope()->addVariable("e", STP_Value(STP_TypeID::NUMBER, Number(constants::E), true));
+        }
+
+        const auto _storage = std::make_shared<STP_InterpStoreLocal>();
+    } // namespace
+
+    void STP_init() { initState(_storage); }
+
+    STP_InterpState STP_createState()
+    {
+        auto state = std::make_shared<STP_InterpStoreLocal>();
+        initState(state);
+        return state;
+    }
 
-    void STP_init()
+    STP_InterpState STP_createChildState(const STP_InterpState& parent)
     {
-        _storage->getGlobalScope()->addVariable("pi", STP_Value(STP_TypeID::NUMBER, Number(constants::PI), true));
-        _storage->getGlobalScope()->addVariable("e", STP_Value(STP_TypeID::NUMBER, Number(constants::E), true));
+        // The built-in constants are copied from the parent as well.
+        auto state = std::make_shared<STP_InterpStoreLocal>();
+        STP_Scope* globalScope = state->getGlobalScope();
+
+        // Inner scopes are visited first, so that their names shadow the outer ones.
+        for (const STP_Scope* scope = parent->getCurrentScope(); scope != nullptr; scope = scope->parentScope)
+        {
+            for (const auto& [name, value] : scope->variables)
+                globalScope->variables.try_emplace(name, value);
+            for (const auto& [name, function] : scope->functions)
+                globalScope->functions.try_emplace(name, function);
+        }
+
+        state->setChunkContext(parent->getChunkContext());
+        state->setFile(parent->getFile());
+        state->setEmbedded();
+        if (parent->isFastMath())
+            state->setFastMath();
+        state->shareEvaluation(*parent);
+        return state;
     }
 
     STP_InterpState STP_getState() { return _storage; }
@@ -46,6 +87,7 @@ namespace steppable::parser
     {
         if (_storage == nullptr)
             throw std::runtime_error("Uninitialized state is destroyed.");
+        _storage->getOutput().flush();
         return 0;
     }
 } // namespace steppable::parser
@@ -25,19 +25,19 @@
 #include "replxx.hxx"
 #include "steppable/stpTypeName.hpp"
 #include "stpInterp/stpErrors.hpp"
+#include "stpInterp/stpEvalWorker.hpp"
+#include "stpInterp/stpIncrementalParse.hpp"
 #include "stpInterp/stpInit.hpp"
 #include "stpInterp/stpInterrupt.hpp"
-#include "stpInterp/stpProcessor.hpp"
 #include "tree_sitter/api.h"
 
-#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <sstream>
-#include <thread>
+#include <string_view>
 
 using namespace std::literals;
 
@@ -58,23 +58,20 @@ namespace steppable::parser
 
     void STP_interactiveHookColor(std::string const& context,
                                   Replxx::colors_t& colors,
-                                  TSParser* parser,
-                                  const std::string& querySource)
+                                  STP_IncrementalParser& parser,
+                                  const TSQuery* query,
+                                  TSQueryCursor* cursor)
     {
         colors.assign(context.length(), replxx::Replxx::Color::DEFAULT); // Default color for all characters
+        if (query == nullptr)
+            return;
 
         TSQueryMatch match;
         uint32_t captureIdx = 0;
-        const TSLanguage* language = ts_parser_language(parser);
-        TSQueryCursor* cursor = ts_query_cursor_new();
-        uint32_t errOffset = 0;
-        TSQueryError errType{};
 
-        TSTree* tree = ts_parser_parse_string(parser, nullptr, context.c_str(), static_cast<uint32_t>(context.size()));
-        TSQuery* query = ts_query_new(language, querySource.c_str(), querySource.length(), &errOffset, &errType);
+        // Owned by the incremental parser, which keeps it to reparse the next keystroke.
+        const TSTree* tree = parser.parse(context);
         ts_query_cursor_exec(cursor, query, ts_tree_root_node(tree));
-        if (errType != TSQueryErrorNone)
-            return;
 
         while (ts_query_cursor_next_capture(cursor, &match, &captureIdx))
         {
@@ -95,9 +92,6 @@ namespace steppable::parser
                     colors[i] = color;
             }
         }
-        ts_query_delete(query);
-        ts_query_cursor_delete(cursor);
-        ts_tree_delete(tree);
     }
 
     int STP_startInteractiveMode(int argc, const char** argv, const STP_InterpState& state, TSParser* parser)
@@ -112,29 +106,64 @@ namespace steppable::parser
         std::ifstream queryFileStream(utils::getBinDir() / "queries" / "highlights.scm");
         querySource << queryFileStream.rdbuf();
 
+        // Used by the highlighter only. The evaluation worker has a parser of its own.
+        STP_IncrementalParser incrementalParser(parser);
+
+        // Compile the query once, and reuse it and the cursor on every keystroke.
+        const std::string querySourceStr = querySource.str();
+        uint32_t errOffset = 0;
+        TSQueryError errType{};
+        TSQuery* query = ts_query_new(ts_parser_language(parser),
+                                      querySourceStr.c_str(),
+                                      static_cast<uint32_t>(querySourceStr.length()),
+                                      &errOffset,
+                                      &errType);
+        if (errType != TSQueryErrorNone and query != nullptr)
+        {
+            ts_query_delete(query);
+            query = nullptr;
+        }
+        TSQueryCursor* cursor = ts_query_cursor_new();
+
         Replxx rx;
         rx.set_highlighter_callback([&](auto&& PH1, auto&& PH2) {
             STP_interactiveHookColor(
-                std::forward<decltype(PH1)>(PH1), std::forward<decltype(PH2)>(PH2), parser, querySource.str());
+                std::forward<decltype(PH1)>(PH1), std::forward<decltype(PH2)>(PH2), incrementalParser, query, cursor);
         });
         rx.set_max_history_size(1024);
 
-        std::thread thread;
-        std::atomic<TSTree*> tree = nullptr;
-        STP_addCtrlCHandler([&]() {
-            state->setExecState(STP_ExecState::REQUEST_STOP);
-            std::cout << "BREAK\n";
+        // Evaluate on a long-lived worker, so that the input stays responsive and a running evaluation can be
+        // cancelled. Its output is printed through replxx, which keeps the prompt intact.
+        STP_EvalWorker worker(state, ts_parser_language(parser));
+        state->getOutput().writeTo([&rx](const std::string_view text) {
+            rx.write(text.data(), static_cast<int>(text.size()));
         });
+        worker.setOnEvaluated([&]() {
+            // Wake up the input, so that it notices the exit.
+            if (state->getExecState() == STP_ExecState::EXIT)
+                rx.emulate_key_press(Replxx::KEY::control('C'));
+        });
+        STP_installInterruptHandler();
 
-        while (state->getExecState() != STP_ExecState::EXIT)
+        while (true)
         {
-            state->setExecState(STP_ExecState::NORMAL);
             source.clear();
 
             if (char const* inputText = rx.input(": "); inputText != nullptr)
                 source = inputText;
             else if (errno == EAGAIN)
             {
+                if (state->getExecState() == STP_ExecState::EXIT)
+                    break;
+
+                // [Ctrl-C] stops the running evaluation, if any.
+                if (worker.isBusy())
+                {
+                    worker.cancel();
+                    rx.print("BREAK\n");
+                    continue;
+                }
+
                 // only allow exit with `exit`.
                 output::info("parser"s, "Type `exit` or [Ctrl-D] to exit."s);
                 continue;
@@ -143,19 +172,16 @@ namespace steppable::parser
                 break;
             rx.history_add(source);
 
-            thread = std::thread([&]() -> void {
-                tree = ts_parser_parse_string(parser, nullptr, source.c_str(), static_cast<uint32_t>(source.size()));
-                TSNode rootNode = ts_tree_root_node(tree);
-                state->setChunk(source, 0, static_cast<long>(source.size()));
-                if (STP_checkRecursiveNodeSanity(rootNode, state))
-                    return;
-
-                STP_processChunkChild(rootNode, state);
-                ts_tree_delete(tree);
-            });
-            if (thread.joinable())
-                thread.join();
+            worker.submit(source);
         }
+
+        // Finish what was entered before [Ctrl-D], then print the rest of the output directly.
+        worker.wait();
+        state->getOutput().writeTo(nullptr);
+
+        if (query != nullptr)
+            ts_query_delete(query);
+        ts_query_cursor_delete(cursor);
         return 0;
     }
 } // namespace steppable::parser
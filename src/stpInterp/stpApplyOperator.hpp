@@ -23,13 +23,32 @@
 #pragma once
 
 #include "steppable/stpTypeName.hpp"
+#include "stpInterp/stpMatrixKernels.hpp"
+#include "stpInterp/stpStore.hpp"
 #include "tree_sitter/api.h"
 
 #include <any>
 #include <memory>
+#include <optional>
 
 namespace steppable::parser
 {
+    /**
+     * @struct STP_MatrixHints
+     * @brief Data kept with matrix values, to save work in later operations on them.
+     */
+    struct STP_MatrixHints
+    {
+        STP_DenseCache* lhsDense = nullptr; ///< Cache of the dense form of the LHS. May be `nullptr`.
+        STP_DenseCache* rhsDense = nullptr; ///< Cache of the dense form of the RHS. May be `nullptr`.
+
+        /// Set to whether a resulting matrix contains a zero, when it is known without another pass over the matrix.
+        std::optional<bool> hasZero;
+
+        /// Set to the dense form of a resulting matrix, when it is calculated by the vectorised kernels.
+        std::shared_ptr<const STP_DenseMatrix> resultDense;
+    };
+
     /**
      * @brief Determine if a binary operation can be done.
      *
@@ -37,13 +56,15 @@ namespace steppable::parser
      * @param lhsType The `STP_TypeID` value for the LHS node.
      * @param operatorStr The operator between LHS and RHS.
      * @param rhsType The `STP_TypeID` value for the RHS node.
+     * @param state The current state of the interpreter.
      * @return std::unique_ptr<STP_TypeID> If the operation can be done, returns a `unique_ptr` to the `STP_TypeID` of
      * the returning value. Otherwise, a `nullptr` is returned.
      */
     std::unique_ptr<STP_TypeID> determineBinaryOperationFeasibility(const TSNode* node,
                                                                     STP_TypeID lhsType,
                                                                     const std::string& operatorStr,
-                                                                    STP_TypeID rhsType);
+                                                                    STP_TypeID rhsType,
+                                                                    const STP_InterpState& state);
 
     /**
      * @brief Performs a binary operation.
@@ -57,14 +78,19 @@ namespace steppable::parser
      * @param operatorStr The operator between LHS and RHS.
      * @param rhsType The `STP_TypeID` value for the RHS node.
      * @param rhsValue The `std::any` value for the RHS node.
+     * @param state The current state of the interpreter.
+     * @param hints If not `nullptr`, the dense forms of the operands, and where to store what is known about the
+     * resulting matrix.
      * @return std::any The value of LHS after the operation is done.
      */
     std::any performBinaryOperation(const TSNode* node,
                                     STP_TypeID lhsType,
-                                    std::any value,
-                                    std::string operatorStr,
+                                    const std::any& value,
+                                    const std::string& operatorStr,
                                     STP_TypeID rhsType,
-                                    std::any rhsValue);
+                                    const std::any& rhsValue,
+                                    const STP_InterpState& state,
+                                    STP_MatrixHints* hints = nullptr);
 
     /**
      * @brief Performs a unary operation.
@@ -73,10 +99,12 @@ namespace steppable::parser
      * @param type The `STP_TypeID` value for the expression node.
      * @param operatorString The unary operator to apply.
      * @param value The value of the expression node.
+     * @param state The current state of the interpreter.
      * @return std::any The result of the operation done.
      */
     std::any performUnaryOperation(const TSNode* node,
                                    STP_TypeID type,
                                    const std::string& operatorString,
-                                   const std::any& value);
+                                   const std::any& value,
+                                   const STP_InterpState& state);
 } // namespace steppable::parser
@@ -0,0 +1,64 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#pragma once
+
+#include "stpInterp/stpLimits.hpp"
+
+#include <string>
+#include <vector>
+
+namespace steppable::parser
+{
+    /**
+     * @struct STP_BatchOptions
+     * @brief Options of a batch run.
+     */
+    struct STP_BatchOptions
+    {
+        size_t jobs = 0; ///< Number of scripts run at the same time. If 0, uses the number of hardware threads.
+        bool fastMath = false; ///< Whether to evaluate numbers with machine types when possible.
+        STP_Limits limits; ///< Limits of each script.
+    };
+
+    /**
+     * @brief Read the paths of the scripts to run from a manifest file, one path per line.
+     * @details Empty lines and lines starting with `#` are skipped.
+     *
+     * @param manifestPath Path to the manifest file.
+     * @param paths The paths read from the manifest are appended here.
+     * @return True if the manifest can be read. False otherwise.
+     */
+    bool STP_readManifest(const std::string& manifestPath, std::vector<std::string>& paths);
+
+    /**
+     * @brief Run many independent scripts on a fixed-size pool of worker threads.
+     * @details Each script gets its own interpreter state and parser. The output of each script is collected, and
+     * written to the standard output in the order of `paths`, as soon as the script and all scripts before it have
+     * finished. An error stops only the script that raised it, and is reported with the path of the script.
+     *
+     * @param paths Paths to the scripts.
+     * @param options Options of the batch run.
+     * @return int The exit code of the program, 1 if any script failed.
+     */
+    int STP_runBatch(const std::vector<std::string>& paths, const STP_BatchOptions& options);
+} // namespace steppable::parser
@@ -0,0 +1,123 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#pragma once
+
+/**
+ * @file stpCApi.h
+ * @brief C interface of the interpreter, for embedding it in other programs.
+ * @details A context holds one independent interpreter state. Variables and functions defined in one call to
+ * `STP_evalString` are visible to later calls on the same context. A context must only be used by one thread at a
+ * time, but different contexts may be used on different threads.
+ */
+
+#include <stddef.h>
+
+#if defined(_WIN32)
+    #if defined(STP_INTERP_BUILD)
+        #define STP_API __declspec(dllexport)
+    #else
+        #define STP_API __declspec(dllimport)
+    #endif
+#else
+    #define STP_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief An opaque interpreter context.
+ */
+typedef struct STP_Context STP_Context;
+
+/**
+ * @brief Results of `STP_evalString`.
+ */
+enum STP_EvalResult
+{
+    STP_EVAL_OK = 0, ///< The code ran to the end.
+    STP_EVAL_ERROR = 1, ///< The code raised an error.
+    STP_EVAL_LIMIT = 2, ///< The code was stopped by a limit set with `STP_setLimits`.
+};
+
+/**
+ * @brief Create a new interpreter context, with the built-in constants defined.
+ *
+ * @return The new context, or `NULL` if it cannot be created.
+ */
+STP_API STP_Context* STP_createContext(void);
+
+/**
+ * @brief Evaluate a piece of source code in a context.
+ * @details Everything the code prints is collected, and can be read with `STP_getResult` afterwards. Execution
+ * stops at the first error.
+ *
+ * @param context The context to evaluate in.
+ * @param source The source code. Does not need to be null-terminated.
+ * @param length Length of the source code in bytes.
+ *
+ * @return One of `STP_EvalResult`. Unless it is `STP_EVAL_OK`, the error message can be read with `STP_getError`.
+ */
+STP_API int STP_evalString(STP_Context* context, const char* source, size_t length);
+
+/**
+ * @brief Set the limits of each evaluation in a context. A limit of 0 means unlimited.
+ *
+ * @param context The context.
+ * @param maxSteps Maximum number of steps, i.e., statements, loop iterations and function calls.
+ * @param timeoutMs Maximum wall-clock time, in milliseconds.
+ * @param maxValueBytes Maximum size of a single value, in bytes. The total size of all values is not limited.
+ */
+STP_API void STP_setLimits(STP_Context* context,
+                           unsigned long long maxSteps,
+                           unsigned long long timeoutMs,
+                           size_t maxValueBytes);
+
+/**
+ * @brief Get the output of the last evaluation.
+ *
+ * @param context The context.
+ * @return The output, valid until the next call to `STP_evalString` or `STP_destroyContext` on this context.
+ */
+STP_API const char* STP_getResult(const STP_Context* context);
+
+/**
+ * @brief Get the error message of the last evaluation.
+ *
+ * @param context The context.
+ * @return The error message, or an empty string if there was no error. Valid until the next call to
+ * `STP_evalString` or `STP_destroyContext` on this context.
+ */
+STP_API const char* STP_getError(const STP_Context* context);
+
+/**
+ * @brief Destroy a context and free all of its resources.
+ *
+ * @param context The context. May be `NULL`.
+ */
+STP_API void STP_destroyContext(STP_Context* context);
+
+#ifdef __cplusplus
+}
+#endif
@@ -57,4 +57,24 @@ namespace steppable::parser
      * @param reason The reason for the error.
      */
     void STP_throwError(const TSNode& node, const STP_InterpState& state, const std::string& reason);
+
+    /**
+     * @brief Print an error message that is not tied to a node, e.g., a limit that is hit.
+     * @details When the output of the state is passed to a writer, such as the REPL printing through replxx from the
+     * evaluation worker, the message is written there too, instead of directly to the terminal.
+     *
+     * @param sink The output sink of the state.
+     * @param message The error message.
+     */
+    void STP_reportError(STP_OutputSink& sink, const std::string& message);
+
+    /**
+     * @brief Report an error recorded by a child state, e.g., one that ran a `pmap` chunk or a spawned task.
+     * @details The error already contains its location, so it is recorded as is when embedded.
+     *
+     * @param node The node that started the child state.
+     * @param state The current state of the interpreter.
+     * @param error The error recorded by the child state.
+     */
+    void STP_rethrowChildError(const TSNode& node, const STP_InterpState& state, const std::string& error);
 } // namespace steppable::parser
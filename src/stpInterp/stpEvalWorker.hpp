@@ -0,0 +1,112 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#pragma once
+
+#include "stpInterp/stpInit.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tree_sitter/api.h>
+
+namespace steppable::parser
+{
+    /**
+     * @class STP_EvalWorker
+     * @brief A long-lived thread that evaluates queued source code in one state.
+     * @details The worker has its own parser, so that the caller may keep using its parser, e.g., for highlighting,
+     * while code is being evaluated. Sources are evaluated one at a time, in the order they were submitted.
+     */
+    class STP_EvalWorker // NOLINT(*-special-member-functions)
+    {
+    public:
+        /**
+         * @brief Start the worker thread.
+         *
+         * @param state The state to evaluate in. Must not be used by other threads while the worker is running.
+         * @param language The language to parse the sources with.
+         */
+        STP_EvalWorker(STP_InterpState state, const TSLanguage* language);
+
+        /**
+         * @brief Cancel the pending sources, finish the current one and join the worker thread.
+         */
+        ~STP_EvalWorker();
+
+        /**
+         * @brief Queue source code to be evaluated.
+         *
+         * @param source The source code.
+         */
+        void submit(std::string source);
+
+        /**
+         * @brief Stop the evaluation that is running, and drop all pending sources.
+         */
+        void cancel();
+
+        /**
+         * @brief Wait until all submitted sources are evaluated.
+         */
+        void wait();
+
+        /**
+         * @brief Gets whether the worker is evaluating or has sources pending.
+         * @return True if busy. False otherwise.
+         */
+        [[nodiscard]] bool isBusy();
+
+        /**
+         * @brief Set a function to call on the worker thread after each evaluation.
+         * @note Set it before submitting any source.
+         *
+         * @param callback The function to call.
+         */
+        void setOnEvaluated(std::function<void()> callback) { onEvaluated = std::move(callback); }
+
+    private:
+        void workerLoop();
+
+        /**
+         * @brief Parse and execute one source.
+         *
+         * @param source The source code.
+         */
+        void evaluate(const std::string& source);
+
+        STP_InterpState state; ///< The state to evaluate in.
+        TSParser* parser; ///< The parser of the worker.
+        std::function<void()> onEvaluated; ///< Called after each evaluation.
+
+        std::deque<std::string> pending; ///< Sources waiting to be evaluated.
+        bool evaluating = false; ///< Whether a source is being evaluated.
+        bool stopping = false; ///< Whether the worker is being destroyed.
+        std::mutex mutex; ///< Guards `pending`, `evaluating` and `stopping`.
+        std::condition_variable changed; ///< Signalled when a source is queued or evaluated, or the worker stops.
+
+        std::thread thread; ///< The worker thread. Started last, after all other members are initialized.
+    };
+} // namespace steppable::parser
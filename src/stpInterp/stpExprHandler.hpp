@@ -87,6 +87,41 @@ namespace steppable::parser
      */
     STP_Value STP_processFnCall(const TSNode* exprNode, const STP_InterpState& state);
 
+    /**
+     * @brief Handle a call to the `pmap(fn, matrix)` builtin.
+     * @details Calls a function defined in Steppable on each element of a matrix, or on each row with `rows=true`, in
+     * parallel on the shared thread pool. Each chunk of elements runs in a child state with its own copy of the scope.
+     * The results are gathered into a matrix, and printed output is written in the order of the elements.
+     *
+     * @param exprNode The function call expression node.
+     * @param state State of the interpreter.
+     *
+     * @return A `steppable::Matrix` wrapped in `STP_Value`.
+     */
+    STP_Value STP_processParallelMap(const TSNode* exprNode, const STP_InterpState& state);
+
+    /**
+     * @brief Handle a call to the `spawn(expr)` builtin.
+     * @details Evaluates the expression on a background thread, in a child state with a snapshot of the current
+     * scope. The returned value is a future, which is resolved when it is read from a variable or passed to `await`.
+     *
+     * @param exprNode The function call expression node.
+     * @param state State of the interpreter.
+     *
+     * @return A future wrapped in `STP_Value`.
+     */
+    STP_Value STP_processSpawn(const TSNode* exprNode, const STP_InterpState& state);
+
+    /**
+     * @brief Handle a call to the `await(expr)` builtin, which waits for a future and returns its value.
+     *
+     * @param exprNode The function call expression node.
+     * @param state State of the interpreter.
+     *
+     * @return The value of the future, or the value of the expression if it is not a future.
+     */
+    STP_Value STP_processAwait(const TSNode* exprNode, const STP_InterpState& state);
+
     /**
      * @brief Handle any Steppable expressions.
      *
@@ -0,0 +1,64 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#pragma once
+
+#include "steppable/number.hpp"
+#include "stpInterp/stpInterrupt.hpp"
+
+#include <cstdint>
+#include <map>
+#include <optional>
+
+namespace steppable::parser
+{
+    /**
+     * @class STP_FactorialEngine
+     * @brief Calculates factorials of integers numerically, without going through the string-based core function.
+     * @details Factorials up to 20! come from a precomputed table. Larger ones are calculated with a binary-splitting
+     * product, starting from the largest factorial calculated so far by the same engine. Use one engine across a
+     * matrix so that its elements share the results.
+     */
+    class STP_FactorialEngine
+    {
+    public:
+        /**
+         * @brief Initializes a new factorial engine.
+         *
+         * @param cancel Checked while multiplying, so that large factorials can be interrupted.
+         */
+        explicit STP_FactorialEngine(const STP_CancelToken& cancel = {}) : cancel(cancel) {}
+
+        /**
+         * @brief Calculate the factorial of a number.
+         * @details Non-integral and negative values are handed to `calc::factorial`.
+         *
+         * @param number The number.
+         * @return The factorial of the number, or `std::nullopt` if it was cancelled before it was complete.
+         */
+        std::optional<Number> operator()(const Number& number);
+
+    private:
+        STP_CancelToken cancel; ///< Stops the calculation when cancelled.
+        std::map<uint64_t, Number> memo; ///< Factorials calculated by this engine, keyed by `n`.
+    };
+} // namespace steppable::parser
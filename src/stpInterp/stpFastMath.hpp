@@ -0,0 +1,124 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#pragma once
+
+#include "steppable/number.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace steppable::parser
+{
+    /**
+     * @struct STP_FastNumber
+     * @brief A number stored with machine types, used in fast-math mode.
+     * @details Integers are stored as `int64_t` and other values as `double`. Operations that cannot be done exactly
+     * with these types (e.g., integer overflow, non-finite results) are carried out with `Number` instead.
+     */
+    struct STP_FastNumber
+    {
+        /**
+         * @enum Kind
+         * @brief The machine type that holds the value.
+         */
+        enum class Kind : uint8_t
+        {
+            NONE = 0, ///< Not a fast number. The value is stored as a `Number`.
+            INTEGER, ///< The value is stored in `integer`.
+            REAL, ///< The value is stored in `real`.
+        };
+
+        Kind kind = Kind::NONE; ///< The machine type that holds the value.
+        int64_t integer = 0; ///< Integer value, valid if `kind` is `Kind::INTEGER`.
+        double real = 0.0; ///< Real value, valid if `kind` is `Kind::REAL`.
+
+        /**
+         * @brief Get the value as a `double`.
+         * @return The value as a `double`.
+         */
+        [[nodiscard]] double asReal() const { return kind == Kind::INTEGER ? static_cast<double>(integer) : real; }
+    };
+
+    /**
+     * @brief Parse a number literal into a fast number.
+     * @details Literals that do not fit into `int64_t`, or have more significant digits than a `double` can hold, are
+     * not parsed, so that they keep their precision.
+     *
+     * @param literal The number literal, as written in the source code.
+     * @return The fast number, or `std::nullopt` if the literal should be stored as a `Number`.
+     */
+    std::optional<STP_FastNumber> STP_parseFastNumber(std::string_view literal);
+
+    /**
+     * @brief Apply a binary operator on two fast numbers.
+     *
+     * @param lhs The LHS value.
+     * @param operatorStr The binary operator.
+     * @param rhs The RHS value.
+     * @param result The result of the operation.
+     *
+     * @return True if the operation is done. False if it should be done with `Number` instead.
+     */
+    bool STP_applyFastBinaryOperator(const STP_FastNumber& lhs,
+                                     const std::string& operatorStr,
+                                     const STP_FastNumber& rhs,
+                                     STP_FastNumber& result);
+
+    /**
+     * @brief Apply a unary operator on a fast number.
+     *
+     * @param operatorStr The unary operator.
+     * @param value The operand.
+     * @param result The result of the operation.
+     *
+     * @return True if the operation is done. False if it should be done with `Number` instead.
+     */
+    bool STP_applyFastUnaryOperator(const std::string& operatorStr, const STP_FastNumber& value, STP_FastNumber& result);
+
+    /**
+     * @brief Format a fast number as a decimal string.
+     * @details Real values are formatted in fixed notation with the shortest representation that round-trips.
+     *
+     * @param value The fast number.
+     * @return The decimal representation of the number.
+     */
+    std::string STP_presentFastNumber(const STP_FastNumber& value);
+
+    /**
+     * @brief Convert an integral `Number` to `int64_t`.
+     *
+     * @param number The number to convert.
+     * @return The integer value, or `std::nullopt` if the number is not an integer or does not fit into `int64_t`.
+     */
+    std::optional<int64_t> STP_numberToInteger(const Number& number);
+
+    /**
+     * @brief Convert a fast number to a `Number`.
+     *
+     * @param value The fast number.
+     * @return The value as a `Number`.
+     */
+    Number STP_fastToNumber(const STP_FastNumber& value);
+} // namespace steppable::parser
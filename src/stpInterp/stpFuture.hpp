@@ -0,0 +1,83 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#pragma once
+
+#include "stpInterp/stpLimits.hpp"
+#include "stpInterp/stpStore.hpp"
+
+#include <future>
+#include <mutex>
+#include <string>
+
+namespace steppable::parser
+{
+    /**
+     * @struct STP_FutureResult
+     * @brief The outcome of a spawned task.
+     */
+    struct STP_FutureResult
+    {
+        STP_Value value = STP_Value(STP_TypeID::NONE); ///< The value of the expression.
+        std::string output; ///< Everything printed while evaluating the expression.
+        std::string error; ///< The error that stopped the task, or empty.
+        STP_LimitKind limitHit = STP_LimitKind::NONE; ///< The limit that stopped the task, if any.
+    };
+
+    /// How often a resolution checks whether the waiting state should stop, in milliseconds.
+    constexpr int STP_FUTURE_POLL_INTERVAL_MS = 10;
+
+    /**
+     * @struct STP_Future
+     * @brief A value that is being computed by a task spawned with `spawn`.
+     * @details The task stops when the evaluation that spawned it stops. When the last copy of a future that was never
+     * resolved is dropped, the task is cancelled, and the destructor waits for it to reach its next safepoint.
+     */
+    struct STP_Future // NOLINT(*-special-member-functions)
+    {
+        std::shared_future<STP_FutureResult> result; ///< Becomes ready when the task finishes.
+
+        std::mutex mutex; ///< Guards `reported`, as copies of the future may be resolved on several threads.
+        bool reported = false; ///< Whether the output and error of the task were reported already.
+
+        STP_InterpState state; ///< The child state running the task.
+
+        ~STP_Future()
+        {
+            if (state != nullptr)
+                state->requestCancel();
+        }
+    };
+
+    /**
+     * @brief Wait for a future, and get its value.
+     * @details The output of the task is written, and its error reported, by the first resolution only. Values that
+     * are not futures are returned unchanged. While waiting, `state` is checked for stops every
+     * `STP_FUTURE_POLL_INTERVAL_MS` milliseconds, so that a task that does not finish cannot hang it.
+     *
+     * @param value The value to resolve.
+     * @param node The node that reads the value, for reporting errors.
+     * @param state The current state of the interpreter.
+     * @return The value computed by the task, or a `NONE` value if the task failed or `state` is stopping.
+     */
+    STP_Value STP_resolveFuture(const STP_Value& value, const TSNode* node, const STP_InterpState& state);
+} // namespace steppable::parser
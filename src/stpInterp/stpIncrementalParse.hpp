@@ -0,0 +1,100 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <tree_sitter/api.h>
+
+namespace steppable::parser
+{
+    /**
+     * @class STP_IncrementalParser
+     * @brief Parser that keeps the previous syntax tree, so that reparsing edited text reuses the unchanged parts.
+     * @details The edit is found by comparing the new text with the previous text. Its common prefix and suffix are
+     * kept and the range between them is applied to the previous tree with `ts_tree_edit`.
+     */
+    class STP_IncrementalParser
+    {
+        TSParser* parser; ///< The underlying parser. Not owned.
+        TSTree* tree = nullptr; ///< The tree of the previous text.
+        std::string text; ///< The previous text.
+        std::vector<TSRange> changedRanges; ///< Ranges changed by the last parse.
+
+    public:
+        /**
+         * @brief Initializes a new incremental parser.
+         *
+         * @param parser The parser object for Steppable. It must outlive this object.
+         */
+        explicit STP_IncrementalParser(TSParser* parser) : parser(parser) {}
+
+        STP_IncrementalParser(const STP_IncrementalParser&) = delete;
+        STP_IncrementalParser& operator=(const STP_IncrementalParser&) = delete;
+
+        /**
+         * @brief Deletes the kept syntax tree.
+         */
+        ~STP_IncrementalParser();
+
+        /**
+         * @brief Parse a new version of the text.
+         *
+         * @param newText The new text.
+         * @return The syntax tree of the text. It is owned by this object and is valid until the next parse, so use
+         * `ts_tree_copy` to keep it.
+         */
+        TSTree* parse(std::string_view newText);
+
+        /**
+         * @brief Get the ranges of the text changed by the last parse, in the coordinates of the new text.
+         * @details These are the ranges whose syntax changed, as reported by `ts_tree_get_changed_ranges`, and the
+         * edited text itself, so that changes of literal values are included. After a parse from scratch, it is the
+         * whole text.
+         *
+         * @return The changed ranges.
+         */
+        [[nodiscard]] const std::vector<TSRange>& getChangedRanges() const { return changedRanges; }
+
+        /**
+         * @brief Forget the previous tree, so that the next parse starts from scratch.
+         */
+        void reset();
+
+        /**
+         * @brief Get the underlying parser.
+         * @return The parser object for Steppable.
+         */
+        [[nodiscard]] TSParser* getParser() const { return parser; }
+    };
+
+    /**
+     * @brief Find the edit that turns one text into another, as the range between their common prefix and suffix.
+     *
+     * @param oldText The previous text.
+     * @param newText The new text.
+     * @return The edit, with the points given as rows and byte columns.
+     */
+    TSInputEdit STP_findEdit(std::string_view oldText, std::string_view newText);
+} // namespace steppable::parser
@@ -28,16 +28,37 @@
 
 namespace steppable::parser
 {
-    using STP_InterpState = std::shared_ptr<STP_InterpStoreLocal>;
-    extern const STP_InterpState _storage;
-
+    /**
+     * @brief Initializes the default state of the interpreter, returned by `STP_getState()`.
+     */
     void STP_init();
 
     /**
-     * @brief Gets the current state of the interpreter.
+     * @brief Create a new, independent state of the interpreter, with the built-in constants defined.
+     * @details Each state has its own scopes, chunk and output, so that many programs can run in one process. A state
+     * must only be used by one thread at a time.
+     *
+     * @return STP_InterpState The new state.
+     */
+    STP_InterpState STP_createState();
+
+    /**
+     * @brief Create a state that runs code on another thread on behalf of `parent`.
+     * @details The variables and functions visible from the current scope of `parent` are copied into the global scope
+     * of the new state, so that assignments on the other thread do not change `parent`. The chunk, flags and limits
+     * are taken over, and the steps and deadline of the current evaluation of `parent` are shared. Errors are recorded
+     * with `setError()` instead of exiting, for the caller to report them.
+     *
+     * @param parent The state to take the scope and settings from. It must not be changed until this returns.
+     * @return STP_InterpState The new state.
+     */
+    STP_InterpState STP_createChildState(const STP_InterpState& parent);
+
+    /**
+     * @brief Gets the default state of the interpreter, used by the command line program.
      * @details If the state is not initialized yet, it will initialize it automatically.
      *
-     * @return STP_InterpState The current state of the interpreter.
+     * @return STP_InterpState The default state of the interpreter.
      */
     STP_InterpState STP_getState();
 
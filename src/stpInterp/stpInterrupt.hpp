@@ -1,6 +1,85 @@
-#include <functional>
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <atomic>
 
 namespace steppable::parser
 {
-    void STP_addCtrlCHandler(const std::function<void(void)>& predicate);
-}
\ No newline at end of file
+    /// Set when the user interrupts the program. Lock-free, so that setting it from a signal handler is safe.
+    inline std::atomic<bool> STP_interruptFlag = false;
+    static_assert(std::atomic<bool>::is_always_lock_free);
+
+    /**
+     * @brief Request the running program to stop at its next safepoint. Safe to call from a signal handler.
+     */
+    inline void STP_requestInterrupt() noexcept { STP_interruptFlag.store(true, std::memory_order_relaxed); }
+
+    /**
+     * @brief Gets whether an interrupt is requested.
+     * @details Only a relaxed load, so that it can be called in hot loops, such as native kernels.
+     *
+     * @return True if an interrupt is requested. False otherwise.
+     */
+    [[nodiscard]] inline bool STP_isInterruptRequested() noexcept
+    {
+        return STP_interruptFlag.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Forget the requested interrupt, e.g., before evaluating the next input.
+     */
+    inline void STP_clearInterrupt() noexcept { STP_interruptFlag.store(false, std::memory_order_relaxed); }
+
+    /**
+     * @struct STP_CancelToken
+     * @brief Tells native code that runs without a state, e.g., kernels on the thread pool, that its evaluation is
+     * stopping. Get one with `STP_InterpStoreLocal::getCancelToken()`.
+     * @note The flags belong to the state, which must outlive the token.
+     */
+    struct STP_CancelToken
+    {
+        const std::atomic<bool>* evaluation = nullptr; ///< Stop flag of the evaluation, or `nullptr`.
+        const std::atomic<bool>* parent = nullptr; ///< Stop flag of the parent evaluation, or `nullptr`.
+
+        /**
+         * @brief Gets whether the program is interrupted, or the evaluation is stopping.
+         * @details Only relaxed loads, so that it can be called in hot loops from any thread.
+         *
+         * @return True if the work should be abandoned. False otherwise.
+         */
+        [[nodiscard]] bool isCancelled() const noexcept
+        {
+            return STP_isInterruptRequested() or
+                   (evaluation != nullptr and evaluation->load(std::memory_order_relaxed)) or
+                   (parent != nullptr and parent->load(std::memory_order_relaxed));
+        }
+    };
+
+    /**
+     * @brief Install a [Ctrl-C] handler that requests an interrupt and prints `BREAK`.
+     * @details The handler only does async-signal-safe work. The program stops at its next safepoint, see
+     * `STP_InterpStoreLocal::shouldStop()`.
+     */
+    void STP_installInterruptHandler();
+} // namespace steppable::parser
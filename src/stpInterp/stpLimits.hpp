@@ -0,0 +1,70 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace steppable::parser
+{
+    /**
+     * @enum STP_LimitKind
+     * @brief Which execution limit stopped an evaluation.
+     */
+    enum class STP_LimitKind : std::uint8_t
+    {
+        NONE, ///< No limit was hit.
+        STEPS, ///< Too many evaluation steps.
+        TIME, ///< The deadline has passed.
+        VALUE_BYTES, ///< A value would be larger than allowed.
+    };
+
+    /**
+     * @struct STP_Limits
+     * @brief Limits of each evaluation in a state. A limit of 0 means unlimited.
+     */
+    struct STP_Limits
+    {
+        /// Maximum number of safepoints passed, i.e., statements, loop iterations and function calls.
+        std::uint64_t maxSteps = 0;
+
+        std::uint64_t timeoutMs = 0; ///< Maximum wall-clock time, in milliseconds.
+
+        /// Maximum size of a single value, in bytes, checked against the predicted size before it is allocated. This is
+        /// a limit per value, not on the total size of all values, so many smaller values can still use more memory.
+        size_t maxValueBytes = 0;
+    };
+
+    /**
+     * @struct STP_Budget
+     * @brief Steps taken and time left in an evaluation. Shared with the child states created during the evaluation,
+     * so that work done on other threads counts towards the same limits.
+     */
+    struct STP_Budget
+    {
+        std::atomic<std::uint64_t> steps = 0; ///< Number of steps taken by the evaluation and its children.
+        std::chrono::steady_clock::time_point deadline; ///< When the evaluation runs out of time.
+    };
+} // namespace steppable::parser
@@ -0,0 +1,263 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#pragma once
+
+#include "steppable/mat2d.hpp"
+#include "stpInterp/stpInterrupt.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace steppable::parser
+{
+    /**
+     * @struct STP_DenseMatrix
+     * @brief A matrix stored as a row-major buffer of `double` values.
+     */
+    struct STP_DenseMatrix
+    {
+        size_t rows = 0; ///< Number of rows.
+        size_t cols = 0; ///< Number of columns.
+        std::vector<double> values; ///< Row-major values, `rows * cols` in size.
+
+        /// Whether all values are exact integers with a magnitude below 2^53. Otherwise, some values are decimals
+        /// rounded to `double`, which is only allowed in fast-math mode.
+        bool integral = true;
+    };
+
+    /**
+     * @struct STP_DenseCache
+     * @brief The dense form of a matrix value, converted once and shared by the copies of the value.
+     */
+    struct STP_DenseCache
+    {
+        std::mutex mutex; ///< Guards the fields below, as values are shared with spawned tasks.
+        bool converted = false; ///< Whether the conversion has been done.
+        std::shared_ptr<const STP_DenseMatrix> dense; ///< The dense form, or `nullptr` if it is not lossless.
+    };
+
+    /**
+     * @struct STP_KernelContext
+     * @brief How the operands of a kernel are converted, and when it gives up.
+     */
+    struct STP_KernelContext
+    {
+        STP_DenseCache* lhsCache = nullptr; ///< The cache of the dense form of the LHS. May be `nullptr`.
+        STP_DenseCache* rhsCache = nullptr; ///< The cache of the dense form of the RHS. May be `nullptr`.
+
+        /// Whether decimals may be rounded to `double`, i.e., in fast-math mode. Otherwise, only integral matrices
+        /// with exact results are calculated by the kernels.
+        bool allowRounding = false;
+
+        STP_CancelToken cancel; ///< Checked by long-running kernels, which give up when it is cancelled.
+    };
+
+    /**
+     * @struct STP_KernelResult
+     * @brief A matrix calculated by the vectorised kernels.
+     */
+    struct STP_KernelResult
+    {
+        Matrix matrix; ///< The resulting matrix.
+        std::shared_ptr<const STP_DenseMatrix> dense; ///< Dense form of the result, to fill the cache of its value.
+    };
+
+    /**
+     * @enum STP_KernelOp
+     * @brief Element-wise operations supported by the vectorised kernels.
+     */
+    enum class STP_KernelOp : uint8_t
+    {
+        ADD, ///< `+`
+        SUB, ///< `-`
+        MUL, ///< `.*`
+        DIV, ///< `./`
+        GT, ///< `>`
+        LT, ///< `<`
+        GE, ///< `>=`
+        LE, ///< `<=`
+    };
+
+    /**
+     * @brief Convert a matrix to a dense `double` buffer.
+     * @details The decimal digits of each element are parsed in place. Integral values with a magnitude below 2^53
+     * are converted exactly. Other values are rounded, and mark the matrix as not `integral`, since decimal fractions
+     * such as 0.1 have no exact binary representation.
+     *
+     * @param matrix The matrix to convert.
+     * @return The dense matrix, or `std::nullopt` if the matrix is ragged or has values that are not finite.
+     */
+    std::optional<STP_DenseMatrix> STP_toDenseMatrix(const Matrix& matrix);
+
+    /**
+     * @brief Get the dense form of a matrix, converting it on first use.
+     *
+     * @param matrix The matrix.
+     * @param cache The cache of the dense form of `matrix`. If `nullptr`, the matrix is converted on every call.
+     * @return The dense matrix, or `nullptr` if it cannot be converted.
+     */
+    std::shared_ptr<const STP_DenseMatrix> STP_getDenseMatrix(const Matrix& matrix, STP_DenseCache* cache);
+
+    /**
+     * @brief Convert a dense buffer back to a matrix. Values of non-integral matrices are written as decimals.
+     *
+     * @param matrix The dense matrix.
+     * @return The matrix of `Number` values.
+     */
+    Matrix STP_fromDenseMatrix(const STP_DenseMatrix& matrix);
+
+    /**
+     * @brief Get the name of the instruction set used by the kernels on this CPU.
+     * @return `"avx2"`, `"sse2"` or `"scalar"`.
+     */
+    const char* STP_kernelIsaName();
+
+    /**
+     * @brief Apply an element-wise operation on two buffers.
+     * @details Comparisons write 1 or 0 to `out`. Arithmetic operations fail if any result is not exactly
+     * representable (its magnitude reaches 2^53, or a division does not give an integer).
+     *
+     * @param op The operation to apply.
+     * @param lhs The LHS buffer.
+     * @param rhs The RHS buffer.
+     * @param out The output buffer. May alias `lhs` or `rhs`.
+     * @param count Number of elements in each buffer.
+     *
+     * @return True if all results are exact. False if the operation should be done with `Number` instead.
+     */
+    bool STP_kernelElementWise(STP_KernelOp op, const double* lhs, const double* rhs, double* out, size_t count);
+
+    /**
+     * @brief Determine if all values in a buffer are non-zero. Stops at the first zero.
+     *
+     * @param values The buffer.
+     * @param count Number of elements in the buffer.
+     *
+     * @return True if no value is zero.
+     */
+    bool STP_kernelAllNonZero(const double* values, size_t count);
+
+    /**
+     * @brief Determine if two buffers hold the same values. Stops at the first difference.
+     *
+     * @param lhs The LHS buffer.
+     * @param rhs The RHS buffer.
+     * @param count Number of elements in each buffer.
+     *
+     * @return True if all values are equal.
+     */
+    bool STP_kernelEqual(const double* lhs, const double* rhs, size_t count);
+
+    /**
+     * @brief Calculate the sum of products of two buffers.
+     *
+     * @param lhs The LHS buffer.
+     * @param rhs The RHS buffer.
+     * @param count Number of elements in each buffer.
+     * @param result The sum of products.
+     *
+     * @return True if the result is exact. False if it should be calculated with `Number` instead.
+     */
+    bool STP_kernelDot(const double* lhs, const double* rhs, size_t count, double& result);
+
+    /**
+     * @brief Multiply two dense matrices with a cache-blocked kernel, in parallel across row blocks.
+     * @note The inner dimensions must match, i.e., `lhs.cols == rhs.rows`.
+     *
+     * @param lhs The LHS matrix.
+     * @param rhs The RHS matrix.
+     * @param cancel Checked before each row block.
+     * @return The product of the matrices, or `std::nullopt` if cancelled before all row blocks are done.
+     */
+    std::optional<STP_DenseMatrix> STP_kernelGemm(const STP_DenseMatrix& lhs,
+                                                  const STP_DenseMatrix& rhs,
+                                                  const STP_CancelToken& cancel = {});
+
+    /**
+     * @brief Apply an element-wise matrix operator with the vectorised kernels.
+     *
+     * @param lhs The LHS matrix.
+     * @param operatorStr The operator: `+`, `-`, `.*`, `./`, `>`, `<`, `>=` or `<=`.
+     * @param rhs The RHS matrix.
+     * @param hasZero If not `nullptr`, set to whether the resulting comparison mask contains a zero. Left untouched
+     * for arithmetic operators.
+     * @param context The caches of the operands, and whether decimals may be rounded.
+     *
+     * @return The resulting matrix, or `std::nullopt` if the operation should be done with `Number` instead.
+     */
+    std::optional<STP_KernelResult> STP_applyMatrixKernel(const Matrix& lhs,
+                                                          const std::string& operatorStr,
+                                                          const Matrix& rhs,
+                                                          std::optional<bool>* hasZero = nullptr,
+                                                          const STP_KernelContext& context = {});
+
+    /**
+     * @brief Compare two matrices as a whole with the vectorised kernels.
+     *
+     * @param lhs The LHS matrix.
+     * @param rhs The RHS matrix.
+     * @param context The caches of the operands, and whether decimals may be rounded.
+     *
+     * @return Whether the matrices are equal, or `std::nullopt` if they should be compared with `Number` instead.
+     */
+    std::optional<bool> STP_applyEqualityKernel(const Matrix& lhs,
+                                                const Matrix& rhs,
+                                                const STP_KernelContext& context = {});
+
+    /**
+     * @brief Calculate the product of a row vector and a column vector with the vectorised kernels.
+     *
+     * @param lhs The LHS matrix, a 1xN row vector.
+     * @param rhs The RHS matrix, a Nx1 column vector.
+     * @param context The caches of the operands, and whether decimals may be rounded.
+     *
+     * @return A 1x1 matrix, or `std::nullopt` if it should be calculated with `Number` instead.
+     */
+    std::optional<STP_KernelResult> STP_applyDotKernel(const Matrix& lhs,
+                                                       const Matrix& rhs,
+                                                       const STP_KernelContext& context = {});
+
+    /**
+     * @brief Multiply two matrices with the cache-blocked kernel.
+     * @details Only used for products with at least `STP_GEMM_MIN_WORK` multiply-adds, where the conversion to
+     * `double` pays off.
+     *
+     * @param lhs The LHS matrix.
+     * @param rhs The RHS matrix.
+     * @param context The caches of the operands, and whether decimals may be rounded.
+     *
+     * @return The product, or `std::nullopt` if it should be calculated with `Number` instead, or the kernel is
+     * cancelled.
+     */
+    std::optional<STP_KernelResult> STP_applyGemmKernel(const Matrix& lhs,
+                                                        const Matrix& rhs,
+                                                        const STP_KernelContext& context = {});
+
+    /// Minimum number of multiply-adds (rows * inner * cols) for `STP_applyGemmKernel` to be used.
+    constexpr size_t STP_GEMM_MIN_WORK = size_t{ 64 } * 64 * 64;
+} // namespace steppable::parser
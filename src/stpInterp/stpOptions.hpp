@@ -0,0 +1,73 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#pragma once
+
+#include "stpInterp/stpLimits.hpp"
+#include "stpInterp/stpOutputSink.hpp"
+
+#include <string>
+#include <vector>
+
+namespace steppable::parser
+{
+    /**
+     * @struct STP_Options
+     * @brief Long options (`--name` or `--name=value`) passed to the interpreter on the command line.
+     */
+    struct STP_Options
+    {
+        bool fastMath = false; ///< Whether to evaluate numbers with machine types when possible.
+        bool stream = false; ///< Whether to execute statements from the standard input as they arrive.
+        bool watch = false; ///< Whether to execute the file again, incrementally, whenever it changes.
+
+        bool batch = false; ///< Whether to run many scripts at once, each with its own state.
+        size_t jobs = 0; ///< Number of scripts run at the same time in batch mode. If 0, uses the hardware threads.
+        std::string manifest; ///< Path to a file listing the scripts to run in batch mode, one per line.
+
+        std::string snapshotIn; ///< Path of a snapshot to restore the global scope from before running.
+        std::string snapshotOut; ///< Path to save a snapshot of the global scope to after running a file.
+
+        std::string servePath; ///< Path of the Unix domain socket to serve evaluation requests on, if any.
+
+        size_t outputBufferSize = STP_OUTPUT_BUFFER_SIZE; ///< Capacity of the output buffer, in bytes.
+        STP_FlushPolicy flushPolicy = STP_FlushPolicy::BLOCK; ///< When printed output is written out.
+
+        STP_Limits limits; ///< Limits of each evaluation.
+
+        std::vector<std::string> positionalArgs; ///< Arguments that are not long options, including `argv[0]`.
+    };
+
+    /**
+     * @brief Extract long options from the command line.
+     * @details Arguments starting with `--` are parsed into `options`. Options that always take a value, e.g.,
+     * `--jobs` and `--serve`, also accept it as the next argument. All other arguments are kept in
+     * `options.positionalArgs` in their original order, so that they can be passed on to `ProgramArgs`.
+     *
+     * @param argc `argc` from `main()`
+     * @param argv `argv` from `main()`
+     * @param options The options object to fill.
+     *
+     * @return True if all options are valid. False otherwise, and an error would have been printed.
+     */
+    bool STP_parseOptions(int argc, const char** argv, STP_Options& options);
+} // namespace steppable::parser
@@ -0,0 +1,143 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace steppable::parser
+{
+    /// Default capacity of the output buffer, in bytes.
+    constexpr size_t STP_OUTPUT_BUFFER_SIZE = 64 * 1024;
+
+    /**
+     * @enum STP_FlushPolicy
+     * @brief When the output sink writes its pending output to the target.
+     */
+    enum class STP_FlushPolicy : std::uint8_t
+    {
+        LINE, ///< After every line.
+        BLOCK, ///< When the buffer is full.
+        EXIT, ///< Only when flushed explicitly, such as on errors or upon exit. The buffer grows as needed.
+    };
+
+    /// A function that receives the output instead of the target stream.
+    using STP_OutputWriter = std::function<void(std::string_view text)>;
+
+    /**
+     * @class STP_OutputSink
+     * @brief Buffered writer for values printed by the program.
+     * @details Output is collected in a fixed-size buffer and written to the target with a single `fwrite` when the
+     * buffer is full or flushed. Writes larger than the buffer go to the target directly. Flush the sink before
+     * writing anything else to the terminal, so that the output stays in order.
+     */
+    class STP_OutputSink
+    {
+        FILE* target; ///< The stream to write to.
+        STP_OutputWriter writer; ///< If set, receives the output instead of `target`.
+        std::vector<char> buffer; ///< Pending output.
+        size_t used = 0; ///< Number of bytes of pending output in the buffer.
+        STP_FlushPolicy policy = STP_FlushPolicy::BLOCK; ///< When pending output is written to the target.
+
+        /**
+         * @brief Write text to the target, or the writer if set.
+         *
+         * @param text The text to write.
+         */
+        void emit(std::string_view text);
+
+    public:
+        /**
+         * @brief Initializes a new output sink.
+         *
+         * @param target The stream to write to.
+         * @param capacity The capacity of the buffer, in bytes.
+         */
+        explicit STP_OutputSink(FILE* target = stdout, size_t capacity = STP_OUTPUT_BUFFER_SIZE);
+
+        STP_OutputSink(const STP_OutputSink&) = delete;
+        STP_OutputSink& operator=(const STP_OutputSink&) = delete;
+
+        /**
+         * @brief Flushes the pending output and destroys the sink.
+         */
+        ~STP_OutputSink();
+
+        /**
+         * @brief Write text to the sink.
+         *
+         * @param text The text to write.
+         */
+        void write(std::string_view text);
+
+        /**
+         * @brief Write a line of text to the sink.
+         *
+         * @param text The text to write, without the trailing newline.
+         */
+        void writeLine(std::string_view text);
+
+        /**
+         * @brief Write all pending output to the target.
+         */
+        void flush();
+
+        /**
+         * @brief Change the capacity of the buffer. Pending output is flushed first.
+         *
+         * @param capacity The new capacity of the buffer, in bytes.
+         */
+        void setBufferSize(size_t capacity);
+
+        /**
+         * @brief Change when pending output is written to the target.
+         *
+         * @param newPolicy The new flush policy.
+         */
+        void setFlushPolicy(const STP_FlushPolicy newPolicy) { policy = newPolicy; }
+
+        /**
+         * @brief Append output to a string instead of writing it to the target, e.g., when embedding the interpreter.
+         *
+         * @param newCapture The string to append output to, or `nullptr` to write to the target again.
+         */
+        void captureTo(std::string* newCapture);
+
+        /**
+         * @brief Pass output to a function instead of writing it to the target, e.g., to print it from another thread.
+         *
+         * @param newWriter The function to pass output to, or an empty function to write to the target again.
+         */
+        void writeTo(STP_OutputWriter newWriter);
+
+        /**
+         * @brief Gets whether the output is passed to a function or captured, instead of written to the target.
+         * @return True if a writer is set. False otherwise.
+         */
+        [[nodiscard]] bool hasWriter() const { return static_cast<bool>(writer); }
+    };
+} // namespace steppable::parser
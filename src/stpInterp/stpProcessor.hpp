@@ -35,6 +35,14 @@ namespace steppable::parser
      */
     void STP_processChunkChild(const TSNode& parent, const STP_InterpState& stpState, bool createNewScope = false);
 
+    /**
+     * @brief Process a single statement node.
+     *
+     * @param node The statement node.
+     * @param state The current state of the interpreter.
+     */
+    void STP_processStatement(const TSNode& node, const STP_InterpState& state);
+
     // Statement processors
 
     /**
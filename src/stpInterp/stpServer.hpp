@@ -0,0 +1,69 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#pragma once
+
+#include "stpInterp/stpOptions.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace steppable::parser
+{
+    /// Largest request accepted by the server, in bytes. Larger requests close the connection.
+    constexpr std::uint32_t STP_SERVE_REQUEST_LIMIT = 64U * 1024U * 1024U;
+
+    /// Largest number of connections served at the same time. Further connections wait until one is closed.
+    constexpr size_t STP_SERVE_CONNECTION_LIMIT = 64;
+
+    /**
+     * @enum STP_ServeStatus
+     * @brief Status of a response of the evaluation server.
+     */
+    enum class STP_ServeStatus : std::uint8_t
+    {
+        OK = 0, ///< The code ran to the end.
+        ERROR = 1, ///< The code raised an error.
+        LIMIT = 2, ///< The code was stopped by a limit.
+    };
+
+    /**
+     * @brief Serve evaluation requests on a Unix domain socket, until interrupted.
+     * @details Each connection gets its own interpreter state, which is kept between its requests, so that variables
+     * and functions defined by one request are visible to the next. Connections are served on threads of their own, at
+     * most `STP_SERVE_CONNECTION_LIMIT` at a time. When interrupted, running evaluations are cancelled and all
+     * connections are closed before returning.
+     *
+     * All integers are unsigned 32-bit, big-endian.
+     * - Request: length of the source, then the source.
+     * - Response: a status byte (`STP_ServeStatus`), then the length of the output and the output, then the length of
+     *   the error message and the error message.
+     *
+     * The connection is closed after the response to a request that calls `exit`.
+     *
+     * @param socketPath Path of the socket. An existing socket at the path is replaced.
+     * @param options Options applied to every state, i.e., fast math and limits.
+     * @return int The exit code of the program.
+     */
+    int STP_runServer(const std::string& socketPath, const STP_Options& options);
+} // namespace steppable::parser
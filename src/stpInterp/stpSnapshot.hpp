@@ -0,0 +1,59 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#pragma once
+
+#include "stpInterp/stpStore.hpp"
+
+#include <string>
+
+extern "C" {
+#include <tree_sitter/api.h>
+}
+
+namespace steppable::parser
+{
+    /**
+     * @brief Save the global scope of the interpreter to a snapshot file.
+     * @details Numbers, matrices, strings and symbols are saved with their constant flags. Functions are saved as the
+     * source text of their declarations. Values of other types, and futures that are still pending, are skipped with a
+     * warning.
+     *
+     * @param path Path of the snapshot file.
+     * @param state The current state of the interpreter.
+     * @return True if the snapshot is written. False otherwise, and an error would have been printed.
+     */
+    bool STP_saveSnapshot(const std::string& path, const STP_InterpState& state);
+
+    /**
+     * @brief Restore the global scope of the interpreter from a snapshot file.
+     * @details The file is read with a single mapping. Variables are added to the global scope first, then the
+     * functions are declared again from their source text, so that their default arguments may refer to the variables.
+     * The whole file is read and checked before anything is added, so a corrupted snapshot leaves the scope unchanged.
+     *
+     * @param path Path of the snapshot file.
+     * @param state The current state of the interpreter.
+     * @param parser The parser used to declare the functions.
+     * @return True if the snapshot is restored. False otherwise, and an error would have been printed.
+     */
+    bool STP_loadSnapshot(const std::string& path, const STP_InterpState& state, TSParser* parser);
+} // namespace steppable::parser
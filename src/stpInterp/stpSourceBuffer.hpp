@@ -0,0 +1,102 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace steppable::parser
+{
+    /// Size of each block read from a stream, in bytes.
+    constexpr size_t STP_STREAM_BLOCK_SIZE = 64 * 1024;
+
+    /**
+     * @class STP_SourceBuffer
+     * @brief Immutable source text of a program.
+     * @details Files are memory-mapped where the platform supports it, so that the parser and the interpreter read
+     * the text in place without copying. Source text from other places, like the standard input or the REPL, is held
+     * in an owned string.
+     */
+    class STP_SourceBuffer
+    {
+        const char* begin = nullptr; ///< Start of the source text.
+        size_t size = 0; ///< Size of the source text, in bytes.
+        void* mapping = nullptr; ///< The memory-mapped region, if any.
+        std::string owned; ///< The source text, if it is not memory-mapped.
+
+        STP_SourceBuffer() = default;
+
+    public:
+        /**
+         * @brief Initializes a source buffer holding a string.
+         *
+         * @param text The source text.
+         */
+        explicit STP_SourceBuffer(std::string text);
+
+        STP_SourceBuffer(const STP_SourceBuffer&) = delete;
+        STP_SourceBuffer& operator=(const STP_SourceBuffer&) = delete;
+
+        /**
+         * @brief Unmaps the file, if it is mapped.
+         */
+        ~STP_SourceBuffer();
+
+        /**
+         * @brief Load a source file, mapping it into memory if possible.
+         *
+         * @param path Path to the source file.
+         * @return The loaded source buffer, or `nullptr` if the file cannot be opened.
+         */
+        static std::shared_ptr<STP_SourceBuffer> fromFile(const std::string& path);
+
+        /**
+         * @brief Read a stream until its end, such as a script piped into the standard input.
+         * @details The stream is read in large blocks into a buffer that grows geometrically. A newline is appended if
+         * the text does not end with one.
+         *
+         * @param stream The stream to read from.
+         * @return The loaded source buffer.
+         */
+        static std::shared_ptr<STP_SourceBuffer> fromStream(FILE* stream);
+
+        /**
+         * @brief Get the source text.
+         * @return A view of the source text, valid as long as the buffer is alive.
+         */
+        [[nodiscard]] std::string_view view() const { return { begin, size }; }
+    };
+
+    /**
+     * @brief Find the first byte that is not part of a valid UTF-8 sequence.
+     * @details Runs of ASCII characters are skipped 16 bytes at a time. Overlong encodings, surrogates and code points
+     * above U+10FFFF are rejected.
+     *
+     * @param text The text to validate.
+     * @return The offset of the first invalid byte, or `text.size()` if the text is valid UTF-8.
+     */
+    size_t STP_findFirstNonUtf8(std::string_view text);
+} // namespace steppable::parser
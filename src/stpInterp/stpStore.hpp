@@ -24,15 +24,26 @@
 #include "fn/calc.hpp"
 #include "steppable/stpArgSpace.hpp"
 #include "steppable/stpTypeName.hpp"
+#include "stpInterp/stpFastMath.hpp"
+#include "stpInterp/stpInterrupt.hpp"
+#include "stpInterp/stpLimits.hpp"
+#include "stpInterp/stpMatrixKernels.hpp"
+#include "stpInterp/stpOutputSink.hpp"
+#include "stpInterp/stpSourceBuffer.hpp"
+#include "stpInterp/stpStringTemplate.hpp"
 
 extern "C" {
 #include <tree_sitter/api.h>
 }
 
 #include <any>
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -43,6 +54,12 @@ extern "C" {
  */
 namespace steppable::parser
 {
+    class STP_InterpStoreLocal;
+    struct STP_Future;
+
+    /// A handle to an interpreter context. Each context has its own scopes, chunk and output.
+    using STP_InterpState = std::shared_ptr<STP_InterpStoreLocal>;
+
     /**
      * @class STP_DynamicLibrary
      * @brief A wrapper class around `dlsym` and `LoadLibraryA`.
@@ -100,30 +117,36 @@ namespace steppable::parser
          * @param node The binary operation node.
          * @param _operatorStr The binary operator.
          * @param rhs The other value.
+         * @param state The current state of the interpreter.
          *
          * @return The resulting value after the operation is done.
          */
         [[nodiscard]] STP_Value applyBinaryOperator(const TSNode* node,
                                                     const std::string& _operatorStr,
-                                                    const STP_Value& rhs) const;
+                                                    const STP_Value& rhs,
+                                                    const STP_InterpState& state) const;
 
         /**
          * @brief Apply a unary operator to the value.
          *
          * @param node The unary operation node.
          * @param _operatorStr The unary operator.
+         * @param state The current state of the interpreter.
          *
          * @return The resulting value after the operation is done.
          */
-        [[nodiscard]] STP_Value applyUnaryOperator(const TSNode* node, const std::string& _operatorStr) const;
+        [[nodiscard]] STP_Value applyUnaryOperator(const TSNode* node,
+                                                   const std::string& _operatorStr,
+                                                   const STP_InterpState& state) const;
 
         /**
          * @brief Convert the value to a C++ boolean value.
          *
          * @param node The expression node.
+         * @param state The current state of the interpreter.
          * @return A boolean value.
          */
-        [[nodiscard]] bool asBool(const TSNode* node) const;
+        [[nodiscard]] bool asBool(const TSNode* node, const STP_InterpState& state) const;
 
         /**
          * @brief Initialize a new `STP_Value` object.
@@ -135,10 +158,92 @@ namespace steppable::parser
          */
         explicit STP_Value(const STP_TypeID& type, const std::any& data = {}, const bool& isConstant_ = false) :
             STP_ValuePrimitive(type, data), isConstant(isConstant_)
+        {
+            resetDenseCache();
+        }
+
+        /**
+         * @brief Initialize a new number stored with machine types.
+         * @details The `data` field is left empty until the value is materialized with `materialize()`.
+         *
+         * @param fast The fast number.
+         */
+        explicit STP_Value(const STP_FastNumber& fast) :
+            STP_ValuePrimitive(STP_TypeID::NUMBER, std::any{}), fastNumber(fast)
         {
         }
 
         [[nodiscard]] bool getIsConstant() const { return isConstant; }
+
+        /**
+         * @brief Determine if the value is a number stored with machine types.
+         * @return True if the value is stored in `fastNumber`. False if it is stored in `data`.
+         */
+        [[nodiscard]] bool isFastNumber() const { return fastNumber.kind != STP_FastNumber::Kind::NONE; }
+
+        /**
+         * @brief Convert a fast number to a `Number` stored in `data`. Other values are left untouched.
+         * @note Call this before accessing `data` or calling `present()` on values that may be fast numbers.
+         */
+        void materialize();
+
+        /**
+         * @brief Get a copy of the value with fast numbers converted to a `Number`.
+         * @note Copies matrices and strings as well. Prefer `presentMaterialized()` to present values.
+         * @return The materialized value.
+         */
+        [[nodiscard]] STP_Value materialized() const&;
+
+        /**
+         * @brief Convert fast numbers of a temporary value to a `Number`, moving the value instead of copying it.
+         * @return The materialized value.
+         */
+        [[nodiscard]] STP_Value materialized() &&;
+
+        /**
+         * @brief Present the value, converting fast numbers first. Other values are presented without being copied.
+         * @note The text is rendered by `present()` of the core library, which owns the format of every type and only
+         * returns a new string. There is no overload that appends to a buffer, so each value is rendered into one
+         * temporary string, which the output sink then takes with a single copy.
+         *
+         * @param name The name of the value.
+         * @param printName Whether to print the name.
+         * @return The presented value.
+         */
+        [[nodiscard]] std::string presentMaterialized(const std::string& name = "", bool printName = true) const;
+
+        STP_FastNumber fastNumber; ///< Machine representation of the number in fast-math mode.
+
+        /// The task computing the value, for values returned by `spawn`. The type is `NONE` until it is resolved with
+        /// `STP_resolveFuture()`.
+        std::shared_ptr<STP_Future> future;
+
+        /**
+         * @brief Determine if the value is still being computed by a spawned task.
+         * @return True if the value is a future. False otherwise.
+         */
+        [[nodiscard]] bool isFuture() const { return future != nullptr; }
+
+        std::optional<bool> matrixHasZero; ///< Whether a matrix value contains a zero, if known. Set by operators
+                                           ///< that produce comparison masks, and used by `asBool()`.
+
+        /**
+         * @brief Give the value a new, empty dense form cache. Call whenever `data` is replaced.
+         * @details The old cache is replaced instead of cleared, as copies of the value share it and still hold the
+         * matrix it was converted from.
+         */
+        void resetDenseCache()
+        {
+            if (typeID == STP_TypeID::MATRIX_2D)
+                denseCache = std::make_shared<STP_DenseCache>();
+            else
+                denseCache = nullptr;
+        }
+
+        /// Dense form of a matrix value, shared by the copies of the value so that it is converted at most once.
+        /// Filled by the first vectorised kernel that uses the value, or by the kernel that calculated it. Only valid
+        /// for the matrix in `data`, see `resetDenseCache()`.
+        std::shared_ptr<STP_DenseCache> denseCache;
     };
 
     /**
@@ -152,25 +257,30 @@ namespace steppable::parser
      */
     struct STP_FunctionDefinition
     {
-        TSNode fnNode; ///< Function declaration node. Store it here so that it does not get deallocated.
+        TSNode fnNode; ///< Body of the function. Refers to `fnTree`, so that it outlives the tree it was parsed in.
 
-        TSTree* fnTree; ///< Tree attached to a function declaration node. Store it here so that it does not get
-                        ///< deallocated.
+        std::shared_ptr<TSTree> fnTree; ///< Copy of the tree of the declaration, owned by the function and its copies.
+
+        std::string source; ///< Source text of the declaration. Used to save the function in snapshots.
 
         std::vector<std::string> posArgNames; ///< Positional argument names.
 
         STP_StringValMap keywordArgs; ///< Keyword arguments specified.
 
-        std::function<STP_Value(STP_StringValMap)>
+        std::function<STP_Value(const STP_InterpState&, const STP_StringValMap&)>
             interpFn; ///< A function that executes Steppable code when the functor is called.
 
         /**
          * @brief Call the functor with arguments.
          *
+         * @param state The state of the interpreter to execute the function in.
          * @param args Arguments to pass to the Steppable function.
          * @return Value returned from the function.
          */
-        STP_Value operator()(const STP_StringValMap& args) const { return interpFn(args); }
+        STP_Value operator()(const STP_InterpState& state, const STP_StringValMap& args) const
+        {
+            return interpFn(state, args);
+        }
     };
 
     /**
@@ -205,10 +315,19 @@ namespace steppable::parser
          *
          * @param node The expression node that fetches the variable. Only collected for bug checking purposes.
          * @param name The name of the variable to get.
+         * @param state The state of the interpreter to report errors to.
          *
          * @return The value of the variable.
          */
-        STP_Value getVariable(const TSNode* node, const std::string& name);
+        STP_Value getVariable(const TSNode* node, const std::string& name, const STP_InterpState& state);
+
+        /**
+         * @brief Find a variable in the scope or its parent scopes, without copying it.
+         *
+         * @param name The name of the variable to find.
+         * @return A pointer to the stored value, or `nullptr` if no such variable exists.
+         */
+        STP_Value* findVariable(const std::string& name);
 
         /**
          * @brief Add a function declaration to the current scope.
@@ -226,10 +345,11 @@ namespace steppable::parser
          *
          * @param node The expression node that calls the function. Only collected for bug checking purposes.
          * @param name The name of the function to get.
+         * @param state The state of the interpreter to report errors to.
          *
          * @return The function object.
          */
-        STP_FunctionDefinition getFunction(const TSNode* node, const std::string& name);
+        STP_FunctionDefinition getFunction(const TSNode* node, const std::string& name, const STP_InterpState& state);
 
         /**
          * @brief Presents all variables in this storage object. Only used for debugging.
@@ -238,6 +358,22 @@ namespace steppable::parser
         [[nodiscard]] std::string present() const;
     };
 
+    /**
+     * @struct STP_ChunkContext
+     * @brief A chunk of source text, and the data derived from it while executing.
+     */
+    struct STP_ChunkContext
+    {
+        std::shared_ptr<const STP_SourceBuffer> source; ///< Owner of the text that `text` points to.
+        std::string_view text; ///< The source text.
+
+        /// Pre-split string literals of the chunk, keyed by the Tree-sitter node ID.
+        std::unordered_map<const void*, std::shared_ptr<const STP_StringTemplate>> stringTemplates;
+
+        /// Guards `stringTemplates`, as functions of the chunk may run on several threads at once, e.g., in `pmap`.
+        mutable std::mutex stringTemplatesMutex;
+    };
+
     /**
      * @class STP_InterpStoreLocal
      * @brief Storage object representing the interpreter state.
@@ -249,18 +385,45 @@ namespace steppable::parser
         STP_Scope* currentScope =
             &globalScope; ///< The current scope the code is executing in. Defaults to the global scope.
 
-        std::string chunk; ///< The chunk that the interpreter is executing.
+        /// The chunk that the interpreter is executing.
+        std::shared_ptr<STP_ChunkContext> chunk = std::make_shared<STP_ChunkContext>();
         size_t chunkStart = 0; ///< Not used.
         size_t chunkEnd = 0; ///< Not used.
 
         bool interactive = false; ///< Whether the interpreter is taking interactive commands.
 
-        STP_ExecState execState = STP_ExecState::NORMAL; ///< Flags of execution state.
+        bool embedded = false; ///< Whether the interpreter is embedded in another program through the C API.
+
+        std::string error; ///< The first error since the last call to `clearError()`. Only recorded when embedded.
+
+        bool fastMath = false; ///< Whether numbers are evaluated with machine types when they fit.
+
+        /// Flags of execution state. Atomic, as it may be set from another thread to stop the execution.
+        std::atomic<STP_ExecState> execState = STP_ExecState::NORMAL;
+
+        /// Set once the current evaluation is stopping, or by `requestCancel()`. Unlike `execState`, it is only reset
+        /// by `startEvaluation()`. Shared with the child states created during the evaluation.
+        std::shared_ptr<std::atomic<bool>> stopFlag = std::make_shared<std::atomic<bool>>(false);
+
+        /// `stopFlag` of the evaluation this state continues, if it is a child state. The state stops with it.
+        std::shared_ptr<const std::atomic<bool>> parentStopFlag;
+
+        STP_Limits limits; ///< Limits of each evaluation.
+        bool budgeted = false; ///< Whether steps or time are limited, so that `shouldStop()` has to count them.
+        std::shared_ptr<STP_Budget> budget = std::make_shared<STP_Budget>(); ///< Budget of the current evaluation.
+        STP_LimitKind limitHit = STP_LimitKind::NONE; ///< The limit that stopped the current evaluation.
+
+        /**
+         * @brief Count a step, and check the step and time limits.
+         */
+        void checkBudget();
 
         std::string file; ///< File name to the current parsing file.
 
         std::vector<STP_DynamicLibrary> loadedLibraries; ///< Imported dynamic libraries.
 
+        STP_OutputSink output; ///< Where printed values are written to.
+
     public:
         /**
          * @brief Initializes a new interpreter state.
@@ -278,6 +441,59 @@ namespace steppable::parser
          */
         void setInteractive() { interactive = true; }
 
+        /**
+         * @brief Gets whether the interpreter is embedded in another program.
+         * @return True if embedded. False otherwise.
+         */
+        [[nodiscard]] bool isEmbedded() const { return embedded; }
+
+        /**
+         * @brief Set the interpreter to run embedded in another program.
+         * @details Errors are recorded with `setError()` and stop the execution, instead of being printed and
+         * exiting the process.
+         */
+        void setEmbedded() { embedded = true; }
+
+        /**
+         * @brief Record an error. Only the first error is kept until `clearError()` is called.
+         *
+         * @param message The error message.
+         */
+        void setError(const std::string& message)
+        {
+            if (error.empty())
+                error = message;
+        }
+
+        /**
+         * @brief Get the first recorded error.
+         * @return The error message, or an empty string if there is no error.
+         */
+        [[nodiscard]] const std::string& getError() const { return error; }
+
+        /**
+         * @brief Forget the recorded error.
+         */
+        void clearError() { error.clear(); }
+
+        /**
+         * @brief Gets whether the interpreter evaluates numbers with machine types when they fit.
+         * @return True if running in fast-math mode. False otherwise.
+         */
+        [[nodiscard]] bool isFastMath() const { return fastMath; }
+
+        /**
+         * @brief Set the interpreter to evaluate numbers with `int64_t` or `double` when they fit.
+         * @details Values are promoted to `Number` on overflow, or if a literal has more digits than a `double` holds.
+         */
+        void setFastMath() { fastMath = true; }
+
+        /**
+         * @brief Get the sink that printed values are written to.
+         * @return The output sink of the interpreter.
+         */
+        STP_OutputSink& getOutput() { return output; }
+
         /**
          * @brief Set a new chunk for the interpreter.
          *
@@ -287,6 +503,28 @@ namespace steppable::parser
          */
         void setChunk(const std::string& newChunk, const size_t& chunkStart, const size_t& chunkEnd);
 
+        /**
+         * @brief Set a new chunk for the interpreter, sharing the source text instead of copying it.
+         *
+         * @param source The source text for the interpreter.
+         */
+        void setChunk(std::shared_ptr<const STP_SourceBuffer> source);
+
+        /**
+         * @brief Get the chunk that the interpreter is executing.
+         * @details Code that outlives the chunk, like function bodies, keeps this to execute in its own chunk later.
+         *
+         * @return The current chunk.
+         */
+        [[nodiscard]] std::shared_ptr<STP_ChunkContext> getChunkContext() const { return chunk; }
+
+        /**
+         * @brief Switch to a chunk obtained from `getChunkContext()`, keeping its cached data.
+         *
+         * @param context The chunk to execute in.
+         */
+        void setChunkContext(std::shared_ptr<STP_ChunkContext> context) { chunk = std::move(context); }
+
         /**
          * @brief Get the current parsing chunk of the interpreter.
          *
@@ -295,6 +533,32 @@ namespace steppable::parser
          */
         std::string getChunk(const TSNode* node = nullptr);
 
+        /**
+         * @brief Get the current parsing chunk of the interpreter without copying it.
+         *
+         * @param node If not `nullptr`, gets the chunk of text associated with the Tree-sitter node.
+         * @return A view of the current parsing chunk, valid until the chunk changes.
+         */
+        [[nodiscard]] std::string_view getChunkView(const TSNode* node = nullptr) const;
+
+        /**
+         * @brief Find the pre-split template of a string literal.
+         *
+         * @param node The string literal node.
+         * @return The template of the string literal, or `nullptr` if it has not been split yet.
+         */
+        [[nodiscard]] std::shared_ptr<const STP_StringTemplate> findStringTemplate(const TSNode* node) const;
+
+        /**
+         * @brief Store the pre-split template of a string literal. Templates live as long as the chunk.
+         *
+         * @param node The string literal node.
+         * @param stringTemplate The template of the string literal.
+         * @return The stored template.
+         */
+        std::shared_ptr<const STP_StringTemplate> addStringTemplate(const TSNode* node,
+                                                                    STP_StringTemplate&& stringTemplate);
+
         /**
          * @brief Add a child scope to the program.
          *
@@ -333,7 +597,7 @@ namespace steppable::parser
          * @brief Get the current execution state.
          * @return Current execution state flag.
          */
-        [[nodiscard]] auto getExecState() const { return execState; }
+        [[nodiscard]] STP_ExecState getExecState() const { return execState.load(); }
 
         /**
          * @brief Set a execution state flag.
@@ -342,6 +606,97 @@ namespace steppable::parser
          */
         void setExecState(const STP_ExecState& state) { execState = state; }
 
+        /**
+         * @brief Check whether the execution should stop. Call at safepoints, such as between statements, at loop
+         * back-edges and at function calls.
+         * @details A requested interrupt or cancel, a stopping parent evaluation, or a step or time limit that is hit,
+         * is turned into `STP_ExecState::REQUEST_STOP` here. A stop is passed on to the child states of the evaluation.
+         *
+         * @return True if the execution is stopping or exiting. False otherwise.
+         */
+        [[nodiscard]] bool shouldStop()
+        {
+            if (getCancelToken().isCancelled()) [[unlikely]]
+                execState = STP_ExecState::REQUEST_STOP;
+            if (budgeted) [[unlikely]]
+                checkBudget();
+
+            const STP_ExecState current = execState.load();
+            const bool stopping = current == STP_ExecState::REQUEST_STOP or current == STP_ExecState::EXIT;
+            if (stopping) [[unlikely]]
+                stopFlag->store(true, std::memory_order_relaxed);
+            return stopping;
+        }
+
+        /**
+         * @brief Stop the current evaluation and its child states at the next safepoint. Other evaluations, such as
+         * tasks spawned by earlier ones, keep running.
+         * @note May be called from any thread, but not at the same time as `startEvaluation()`.
+         */
+        void requestCancel() { stopFlag->store(true, std::memory_order_relaxed); }
+
+        /**
+         * @brief Get a token that tells native code whether the current evaluation is stopping.
+         * @return The token. Valid until the next call to `startEvaluation()`.
+         */
+        [[nodiscard]] STP_CancelToken getCancelToken() const
+        {
+            return STP_CancelToken{ .evaluation = stopFlag.get(), .parent = parentStopFlag.get() };
+        }
+
+        /**
+         * @brief Set the limits of each evaluation.
+         *
+         * @param newLimits The new limits.
+         */
+        void setLimits(const STP_Limits& newLimits);
+
+        /**
+         * @brief Get the limits of each evaluation.
+         * @return The limits.
+         */
+        [[nodiscard]] const STP_Limits& getLimits() const { return limits; }
+
+        /**
+         * @brief Start counting steps and time for a new evaluation.
+         */
+        void startEvaluation();
+
+        /**
+         * @brief Continue the current evaluation of another state, e.g., in a child state that runs part of it.
+         * @details The limits are copied, and the steps and deadline are shared, so that the child cannot reset them.
+         * The child stops when the evaluation of `parent` stops.
+         *
+         * @param parent The state whose evaluation is continued.
+         */
+        void shareEvaluation(const STP_InterpStoreLocal& parent);
+
+        /**
+         * @brief Get the limit that stopped the current evaluation.
+         * @return The limit, or `STP_LimitKind::NONE` if no limit was hit.
+         */
+        [[nodiscard]] STP_LimitKind getLimitHit() const { return limitHit; }
+
+        /**
+         * @brief Stop the execution because a limit is hit, and report it. Only the first limit hit is reported.
+         *
+         * @param kind The limit that is hit.
+         */
+        void hitLimit(STP_LimitKind kind);
+
+        /**
+         * @brief Check that a value of `count` elements, `elementBytes` each, is not larger than
+         * `STP_Limits::maxValueBytes`.
+         * @details Call before allocating a value whose size depends on the input, e.g., repeated strings or ranges.
+         * Stops the execution if it is too large. Each value is checked on its own; the total size of the values that
+         * are alive is not tracked.
+         *
+         * @param elementBytes Size of each element, in bytes.
+         * @param count Number of elements.
+         * @return True if the value may be created. False otherwise.
+         */
+        [[nodiscard]] bool checkValueSize(size_t elementBytes, size_t count);
+
         /**
          * @brief Get the file name of the current parsing file.
          * @return The file name of the current parsing file.
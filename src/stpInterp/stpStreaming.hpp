@@ -0,0 +1,47 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#pragma once
+
+#include "stpInterp/stpInit.hpp"
+
+#include <cstdio>
+#include <tree_sitter/api.h>
+
+namespace steppable::parser
+{
+    /// Largest amount of unexecuted source text kept while waiting for a statement to complete, in bytes.
+    constexpr size_t STP_STREAM_WINDOW_LIMIT = 16 * 1024 * 1024;
+
+    /**
+     * @brief Execute a program as it arrives on a stream, one top-level statement at a time.
+     * @details Text is read as soon as it is available. A top-level statement is executed once the next one is
+     * complete, or the stream ends, and is then dropped. Only statements that can still continue, such as an
+     * unclosed loop body or an `if` that may get an `else`, are kept in memory. The first error stops the stream.
+     *
+     * @param stream The stream to read the program from.
+     * @param state The current state of the interpreter.
+     * @param parser The parser object for Steppable.
+     * @return int The exit code of the program.
+     */
+    int STP_runStreaming(FILE* stream, const STP_InterpState& state, TSParser* parser);
+} // namespace steppable::parser
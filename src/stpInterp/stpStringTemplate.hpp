@@ -0,0 +1,54 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#pragma once
+
+extern "C" {
+#include <tree_sitter/api.h>
+}
+
+#include <string>
+#include <vector>
+
+namespace steppable::parser
+{
+    /**
+     * @struct STP_StringSegment
+     * @brief A part of a string literal, either literal text or a formatting snippet to evaluate.
+     */
+    struct STP_StringSegment
+    {
+        std::string literal; ///< Literal text with escape sequences already decoded.
+        TSNode hole{}; ///< The formatting expression to evaluate. Only valid if `isHole` is true.
+        bool isHole = false; ///< Whether this segment is a formatting snippet.
+    };
+
+    /**
+     * @struct STP_StringTemplate
+     * @brief A string literal split into segments once, so that it can be evaluated in one pass.
+     */
+    struct STP_StringTemplate
+    {
+        std::vector<STP_StringSegment> segments; ///< Segments of the string, in order.
+        size_t literalSize = 0; ///< Total size of all literal segments, used to reserve the result.
+    };
+} // namespace steppable::parser
@@ -0,0 +1,99 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace steppable::parser
+{
+    /**
+     * @class STP_ThreadPool
+     * @brief A fixed-size pool of worker threads.
+     */
+    class STP_ThreadPool // NOLINT(*-special-member-functions)
+    {
+    public:
+        /**
+         * @brief Start the worker threads.
+         *
+         * @param threadCount Number of worker threads. If 0, uses the number of hardware threads.
+         */
+        explicit STP_ThreadPool(size_t threadCount = 0);
+
+        /**
+         * @brief Finish all queued tasks and join the worker threads.
+         */
+        ~STP_ThreadPool();
+
+        /**
+         * @brief Queue a task to run on a worker thread.
+         *
+         * @param task The task to run.
+         */
+        void submit(std::function<void()> task);
+
+        /**
+         * @brief Run a function over a range of indices in parallel, and wait until it is done.
+         * @details The range is split into chunks of at least `grain` indices. The calling thread takes chunks as
+         * well, so it is safe to call this from a task running in the pool.
+         *
+         * @param begin The first index.
+         * @param end One past the last index.
+         * @param grain Minimum number of indices in each chunk.
+         * @param fn A function that processes indices in `[chunkBegin, chunkEnd)`.
+         */
+        void parallelFor(size_t begin,
+                         size_t end,
+                         size_t grain,
+                         const std::function<void(size_t chunkBegin, size_t chunkEnd)>& fn);
+
+        /**
+         * @brief Get the number of worker threads.
+         * @return The number of worker threads.
+         */
+        [[nodiscard]] size_t size() const { return workers.size(); }
+
+        /**
+         * @brief Get the pool shared by the interpreter.
+         * @details The pool is created on first use, with one worker per hardware thread.
+         *
+         * @return The shared thread pool.
+         */
+        static STP_ThreadPool& shared();
+
+    private:
+        void workerLoop();
+
+        std::vector<std::thread> workers; ///< Worker threads.
+        std::queue<std::function<void()>> tasks; ///< Queued tasks.
+        std::mutex mutex; ///< Guards `tasks` and `stopping`.
+        std::condition_variable taskAvailable; ///< Signalled when a task is queued or the pool is stopping.
+        bool stopping = false; ///< Whether the pool is being destroyed.
+    };
+} // namespace steppable::parser
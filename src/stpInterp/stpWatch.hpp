@@ -0,0 +1,50 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#pragma once
+
+#include "stpInterp/stpInit.hpp"
+
+#include <string>
+#include <tree_sitter/api.h>
+
+namespace steppable::parser
+{
+    /// Interval between checks of the watched file where file system notifications are not available.
+    constexpr int STP_WATCH_POLL_INTERVAL_MS = 250;
+
+    /**
+     * @brief Execute a file, then execute it again whenever it changes, re-executing only what the change affects.
+     * @details The file is reparsed incrementally. The global scope is copied once before the first run, and after
+     * each top-level statement only the values of the names it assigns are kept. Statements before the first changed
+     * one are skipped. The scope is rewound to its state before that statement, which is then executed. Each later
+     * statement is executed again if it is new or changed, or if it uses a name, directly or through the functions
+     * it calls, that was assigned by a statement that was executed again or removed. Otherwise, the values it
+     * assigned in the previous run are restored instead.
+     *
+     * @param path Path to the file to watch.
+     * @param state The current state of the interpreter.
+     * @param parser The parser object for Steppable.
+     * @return int The exit code of the program.
+     */
+    int STP_runWatch(const std::string& path, const STP_InterpState& state, TSParser* parser);
+} // namespace steppable::parser
@@ -1,38 +1,79 @@
-#include <functional>
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include "stpInterp/stpInterrupt.hpp"
+
 #ifndef WINDOWS
     #include <csignal>
+    #include <unistd.h>
 #else
+    #include <cstdio>
     #include <windows.h>
 #endif
 
 namespace steppable::parser
 {
-    static std::function<void(void)> handler;
-#ifdef WINDOWS
-    static BOOL WINAPI CtrlHandler(DWORD fdwCtrlType)
+    namespace
     {
-        if (fdwCtrlType == CTRL_C_EVENT)
+        constexpr char BREAK_MESSAGE[] = "BREAK\n"; // NOLINT(*-avoid-c-arrays)
+
+#ifdef WINDOWS
+        /**
+         * @brief Console control handler. Runs on a thread of its own.
+         *
+         * @param fdwCtrlType The type of the control signal.
+         * @return `TRUE` if the signal is handled.
+         */
+        BOOL WINAPI ctrlHandler(DWORD fdwCtrlType)
         {
-            if (handler)
-                handler();
+            if (fdwCtrlType != CTRL_C_EVENT)
+                return FALSE;
+
+            STP_requestInterrupt();
+            std::fputs(BREAK_MESSAGE, stdout);
             return TRUE;
         }
-        return FALSE;
-    }
-
+#else
+        /**
+         * @brief `SIGINT` handler. Only calls async-signal-safe functions.
+         */
+        void sigintHandler(int /*signal*/)
+        {
+            STP_requestInterrupt();
+            (void)!write(STDOUT_FILENO, BREAK_MESSAGE, sizeof(BREAK_MESSAGE) - 1);
+        }
 #endif
+    } // namespace
 
-    void STP_addCtrlCHandler(const std::function<void(void)>& predicate)
+    void STP_installInterruptHandler()
     {
 #ifdef WINDOWS
-        handler = predicate;
-        SetConsoleCtrlHandler(CtrlHandler, TRUE);
+        SetConsoleCtrlHandler(ctrlHandler, TRUE);
 #else
-        handler = predicate;
-        (void)std::signal(SIGINT, [](int) {
-            if (handler)
-                handler();
-        });
+        struct sigaction action = {};
+        action.sa_handler = sigintHandler;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        sigaction(SIGINT, &action, nullptr);
 #endif
     }
-} // namespace steppable::parser
\ No newline at end of file
+} // namespace steppable::parser
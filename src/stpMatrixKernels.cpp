@@ -0,0 +1,726 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include "stpInterp/stpMatrixKernels.hpp"
+
+#include "steppable/number.hpp"
+#include "stpInterp/stpFastMath.hpp"
+#include "stpInterp/stpInterrupt.hpp"
+#include "stpInterp/stpThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define STP_KERNELS_X86
+    #include <immintrin.h>
+#endif
+
+namespace steppable::parser
+{
+    namespace
+    {
+        /// Integral values below this magnitude are exact in `double`, and so are sums and products below it.
+        constexpr double EXACT_LIMIT = 9007199254740992.0; // 2^53
+
+        enum class Isa : uint8_t
+        {
+            SCALAR,
+            SSE2,
+            AVX2,
+        };
+
+        Isa detectIsa()
+        {
+            static const Isa isa = [] {
+#ifdef STP_KERNELS_X86
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx2"))
+                    return Isa::AVX2;
+                if (__builtin_cpu_supports("sse2"))
+                    return Isa::SSE2;
+#endif
+                return Isa::SCALAR;
+            }();
+            return isa;
+        }
+
+        bool isArithmetic(const STP_KernelOp op)
+        {
+            return op == STP_KernelOp::ADD or op == STP_KernelOp::SUB or op == STP_KernelOp::MUL or
+                   op == STP_KernelOp::DIV;
+        }
+
+        double applyScalar(const STP_KernelOp op, const double a, const double b)
+        {
+            switch (op)
+            {
+            case STP_KernelOp::ADD:
+                return a + b;
+            case STP_KernelOp::SUB:
+                return a - b;
+            case STP_KernelOp::MUL:
+                return a * b;
+            case STP_KernelOp::DIV:
+                return a / b;
+            case STP_KernelOp::GT:
+                return a > b ? 1.0 : 0.0;
+            case STP_KernelOp::LT:
+                return a < b ? 1.0 : 0.0;
+            case STP_KernelOp::GE:
+                return a >= b ? 1.0 : 0.0;
+            case STP_KernelOp::LE:
+                return a <= b ? 1.0 : 0.0;
+            }
+            return 0.0;
+        }
+
+        /// Check that a result is exact. NaN and infinity fail the check as well.
+        bool isExact(const STP_KernelOp op, const double value)
+        {
+            if (not(std::abs(value) < EXACT_LIMIT))
+                return false;
+            return op != STP_KernelOp::DIV or std::trunc(value) == value;
+        }
+
+        bool elementWiseScalar(
+            const STP_KernelOp op, const double* lhs, const double* rhs, double* out, const size_t begin, const size_t count)
+        {
+            bool exact = true;
+            const bool checkExact = isArithmetic(op);
+            for (size_t i = begin; i < count; i++)
+            {
+                out[i] = applyScalar(op, lhs[i], rhs[i]);
+                if (checkExact)
+                    exact = exact and isExact(op, out[i]);
+            }
+            return exact;
+        }
+
+#ifdef STP_KERNELS_X86
+        template<STP_KernelOp Op>
+        __attribute__((target("avx2"))) bool elementWiseAvx2(const double* lhs,
+                                                              const double* rhs,
+                                                              double* out,
+                                                              const size_t count)
+        {
+            const __m256d limit = _mm256_set1_pd(EXACT_LIMIT);
+            const __m256d signMask = _mm256_set1_pd(-0.0);
+            const __m256d one = _mm256_set1_pd(1.0);
+            __m256d inexact = _mm256_setzero_pd();
+
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m256d a = _mm256_loadu_pd(lhs + i);
+                const __m256d b = _mm256_loadu_pd(rhs + i);
+                __m256d r;
+                if constexpr (Op == STP_KernelOp::ADD)
+                    r = _mm256_add_pd(a, b);
+                else if constexpr (Op == STP_KernelOp::SUB)
+                    r = _mm256_sub_pd(a, b);
+                else if constexpr (Op == STP_KernelOp::MUL)
+                    r = _mm256_mul_pd(a, b);
+                else if constexpr (Op == STP_KernelOp::DIV)
+                    r = _mm256_div_pd(a, b);
+                else if constexpr (Op == STP_KernelOp::GT)
+                    r = _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_GT_OQ), one);
+                else if constexpr (Op == STP_KernelOp::LT)
+                    r = _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_LT_OQ), one);
+                else if constexpr (Op == STP_KernelOp::GE)
+                    r = _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_GE_OQ), one);
+                else
+                    r = _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_LE_OQ), one);
+
+                if constexpr (Op == STP_KernelOp::ADD or Op == STP_KernelOp::SUB or Op == STP_KernelOp::MUL or
+                              Op == STP_KernelOp::DIV)
+                {
+                    // |r| >= 2^53, or NaN
+                    const __m256d magnitude = _mm256_andnot_pd(signMask, r);
+                    inexact = _mm256_or_pd(inexact, _mm256_cmp_pd(magnitude, limit, _CMP_NLT_UQ));
+                }
+                if constexpr (Op == STP_KernelOp::DIV)
+                {
+                    const __m256d truncated = _mm256_round_pd(r, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+                    inexact = _mm256_or_pd(inexact, _mm256_cmp_pd(truncated, r, _CMP_NEQ_UQ));
+                }
+                _mm256_storeu_pd(out + i, r);
+            }
+
+            const bool tailExact = elementWiseScalar(Op, lhs, rhs, out, i, count);
+            return _mm256_movemask_pd(inexact) == 0 and tailExact;
+        }
+
+        template<STP_KernelOp Op>
+        __attribute__((target("sse2"))) bool elementWiseSse2(const double* lhs,
+                                                              const double* rhs,
+                                                              double* out,
+                                                              const size_t count)
+        {
+            const __m128d limit = _mm_set1_pd(EXACT_LIMIT);
+            const __m128d signMask = _mm_set1_pd(-0.0);
+            const __m128d one = _mm_set1_pd(1.0);
+            __m128d inexact = _mm_setzero_pd();
+
+            size_t i = 0;
+            for (; i + 2 <= count; i += 2)
+            {
+                const __m128d a = _mm_loadu_pd(lhs + i);
+                const __m128d b = _mm_loadu_pd(rhs + i);
+                __m128d r;
+                if constexpr (Op == STP_KernelOp::ADD)
+                    r = _mm_add_pd(a, b);
+                else if constexpr (Op == STP_KernelOp::SUB)
+                    r = _mm_sub_pd(a, b);
+                else if constexpr (Op == STP_KernelOp::MUL)
+                    r = _mm_mul_pd(a, b);
+                else if constexpr (Op == STP_KernelOp::DIV)
+                    r = _mm_div_pd(a, b);
+                else if constexpr (Op == STP_KernelOp::GT)
+                    r = _mm_and_pd(_mm_cmpgt_pd(a, b), one);
+                else if constexpr (Op == STP_KernelOp::LT)
+                    r = _mm_and_pd(_mm_cmplt_pd(a, b), one);
+                else if constexpr (Op == STP_KernelOp::GE)
+                    r = _mm_and_pd(_mm_cmpge_pd(a, b), one);
+                else
+                    r = _mm_and_pd(_mm_cmple_pd(a, b), one);
+
+                if constexpr (Op == STP_KernelOp::ADD or Op == STP_KernelOp::SUB or Op == STP_KernelOp::MUL or
+                              Op == STP_KernelOp::DIV)
+                {
+                    const __m128d magnitude = _mm_andnot_pd(signMask, r);
+                    inexact = _mm_or_pd(inexact, _mm_cmpnlt_pd(magnitude, limit));
+                }
+                _mm_storeu_pd(out + i, r);
+            }
+
+            bool exact = _mm_movemask_pd(inexact) == 0;
+            // SSE2 has no rounding instruction, check integral quotients separately.
+            if constexpr (Op == STP_KernelOp::DIV)
+                for (size_t j = 0; j < i and exact; j++)
+                    exact = std::trunc(out[j]) == out[j];
+
+            const bool tailExact = elementWiseScalar(Op, lhs, rhs, out, i, count);
+            return exact and tailExact;
+        }
+
+        template<STP_KernelOp Op>
+        bool elementWiseDispatch(const double* lhs, const double* rhs, double* out, const size_t count)
+        {
+            switch (detectIsa())
+            {
+            case Isa::AVX2:
+                return elementWiseAvx2<Op>(lhs, rhs, out, count);
+            case Isa::SSE2:
+                return elementWiseSse2<Op>(lhs, rhs, out, count);
+            default:
+                return elementWiseScalar(Op, lhs, rhs, out, 0, count);
+            }
+        }
+
+        __attribute__((target("avx2"))) bool allNonZeroAvx2(const double* values, const size_t count)
+        {
+            const __m256d zero = _mm256_setzero_pd();
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+                if (_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(values + i), zero, _CMP_EQ_OQ)) != 0)
+                    return false;
+            for (; i < count; i++)
+                if (values[i] == 0.0)
+                    return false;
+            return true;
+        }
+
+        __attribute__((target("avx2"))) bool equalAvx2(const double* lhs, const double* rhs, const size_t count)
+        {
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m256d a = _mm256_loadu_pd(lhs + i);
+                const __m256d b = _mm256_loadu_pd(rhs + i);
+                if (_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_NEQ_UQ)) != 0)
+                    return false;
+            }
+            for (; i < count; i++)
+                if (lhs[i] != rhs[i])
+                    return false;
+            return true;
+        }
+
+        __attribute__((target("avx2"))) bool dotAvx2(const double* lhs,
+                                                     const double* rhs,
+                                                     const size_t count,
+                                                     double& result)
+        {
+            const __m256d signMask = _mm256_set1_pd(-0.0);
+            __m256d sum = _mm256_setzero_pd();
+            __m256d bound = _mm256_setzero_pd();
+
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m256d product = _mm256_mul_pd(_mm256_loadu_pd(lhs + i), _mm256_loadu_pd(rhs + i));
+                sum = _mm256_add_pd(sum, product);
+                bound = _mm256_add_pd(bound, _mm256_andnot_pd(signMask, product));
+            }
+
+            alignas(32) double sums[4];
+            alignas(32) double bounds[4];
+            _mm256_store_pd(sums, sum);
+            _mm256_store_pd(bounds, bound);
+            double total = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+            double totalBound = (bounds[0] + bounds[1]) + (bounds[2] + bounds[3]);
+            for (; i < count; i++)
+            {
+                total += lhs[i] * rhs[i];
+                totalBound += std::abs(lhs[i] * rhs[i]);
+            }
+
+            result = total;
+            return totalBound < EXACT_LIMIT;
+        }
+#else
+        template<STP_KernelOp Op>
+        bool elementWiseDispatch(const double* lhs, const double* rhs, double* out, const size_t count)
+        {
+            return elementWiseScalar(Op, lhs, rhs, out, 0, count);
+        }
+#endif
+
+        bool dotScalar(const double* lhs, const double* rhs, const size_t count, double& result)
+        {
+            double total = 0.0;
+            double totalBound = 0.0;
+            for (size_t i = 0; i < count; i++)
+            {
+                total += lhs[i] * rhs[i];
+                totalBound += std::abs(lhs[i] * rhs[i]);
+            }
+
+            // Every partial sum is bounded by `totalBound`, so all of them are exact if it is.
+            result = total;
+            return totalBound < EXACT_LIMIT;
+        }
+
+        // Tile sizes for the matrix product. A block of `GEMM_BLOCK_K` rows of the RHS, `GEMM_BLOCK_N` wide, stays
+        // in L2 cache while a block of `GEMM_BLOCK_M` rows of the LHS is multiplied with it.
+        constexpr size_t GEMM_BLOCK_M = 64;
+        constexpr size_t GEMM_BLOCK_K = 256;
+        constexpr size_t GEMM_BLOCK_N = 512;
+
+        void gemmRowBlock(const STP_DenseMatrix& lhs,
+                          const STP_DenseMatrix& rhs,
+                          STP_DenseMatrix& out,
+                          const size_t rowBegin,
+                          const size_t rowEnd)
+        {
+            const size_t inner = lhs.cols;
+            const size_t cols = rhs.cols;
+            const double* a = lhs.values.data();
+            const double* b = rhs.values.data();
+            double* c = out.values.data();
+
+            for (size_t kk = 0; kk < inner; kk += GEMM_BLOCK_K)
+            {
+                const size_t kEnd = std::min(inner, kk + GEMM_BLOCK_K);
+                for (size_t jj = 0; jj < cols; jj += GEMM_BLOCK_N)
+                {
+                    const size_t jEnd = std::min(cols, jj + GEMM_BLOCK_N);
+                    for (size_t i = rowBegin; i < rowEnd; i++)
+                    {
+                        double* cRow = c + (i * cols);
+                        for (size_t k = kk; k < kEnd; k++)
+                        {
+                            const double aik = a[(i * inner) + k];
+                            const double* bRow = b + (k * cols);
+                            // Contiguous in `j`, so the compiler vectorises this loop.
+                            for (size_t j = jj; j < jEnd; j++)
+                                cRow[j] += aik * bRow[j];
+                        }
+                    }
+                }
+            }
+        }
+
+        double maxMagnitude(const std::vector<double>& values)
+        {
+            double result = 0.0;
+            for (const double value : values)
+                result = std::max(result, std::abs(value));
+            return result;
+        }
+
+        /**
+         * @brief Parse the decimal digits of a number into a `double`.
+         *
+         * @param number The number.
+         * @param value The parsed value.
+         * @param exact Set to whether `value` is exactly the number, i.e., an integer with a magnitude below 2^53.
+         * @return True if the number is parsed. False if it is not a finite decimal.
+         */
+        bool parseNumber(const Number& number, double& value, bool& exact)
+        {
+            // `present()` gives the digits stored in the number. Short values fit in the small-string buffer.
+            const std::string text = number.present();
+            const char* first = text.data();
+            const char* last = first + text.size();
+
+            // Accept trailing zeros after the decimal point, e.g., `3.000`.
+            const size_t point = text.find('.');
+            if (point == std::string::npos or text.find_first_not_of('0', point + 1) == std::string::npos)
+            {
+                const char* integerLast = point == std::string::npos ? last : first + point;
+                int64_t integer = 0;
+                if (const auto [ptr, ec] = std::from_chars(first, integerLast, integer);
+                    ec == std::errc{} and ptr == integerLast and std::abs(static_cast<double>(integer)) < EXACT_LIMIT)
+                {
+                    value = static_cast<double>(integer);
+                    exact = true;
+                    return true;
+                }
+            }
+
+            exact = false;
+            const auto [ptr, ec] = std::from_chars(first, last, value);
+            return ec == std::errc{} and ptr == last and std::isfinite(value);
+        }
+
+        bool allFinite(const std::vector<double>& values)
+        {
+            return std::ranges::all_of(values, [](const double value) { return std::isfinite(value); });
+        }
+
+        /**
+         * @brief Decide whether a kernel result may be used.
+         *
+         * @param exact Whether the operands are integral, and the kernel found the result to be exact.
+         * @param result The result of the kernel. Marked as not `integral` if it is rounded.
+         * @param context The context of the kernel.
+         * @return True if the result may be used. False if it should be calculated with `Number` instead.
+         */
+        bool acceptResult(const bool exact, STP_DenseMatrix& result, const STP_KernelContext& context)
+        {
+            result.integral = exact;
+            return exact or (context.allowRounding and allFinite(result.values));
+        }
+
+        /**
+         * @brief Get the dense forms of both operands of a kernel.
+         *
+         * @param lhs The LHS matrix.
+         * @param rhs The RHS matrix.
+         * @param context The context of the kernel.
+         * @return The dense forms, or `nullptr`s if either cannot be used, e.g., has decimals without rounding allowed.
+         */
+        std::pair<std::shared_ptr<const STP_DenseMatrix>, std::shared_ptr<const STP_DenseMatrix>> getOperands(
+            const Matrix& lhs, const Matrix& rhs, const STP_KernelContext& context)
+        {
+            auto lhsDense = STP_getDenseMatrix(lhs, context.lhsCache);
+            if (not lhsDense or (not lhsDense->integral and not context.allowRounding))
+                return {};
+            auto rhsDense = STP_getDenseMatrix(rhs, context.rhsCache);
+            if (not rhsDense or (not rhsDense->integral and not context.allowRounding))
+                return {};
+            return { std::move(lhsDense), std::move(rhsDense) };
+        }
+
+        std::optional<STP_KernelOp> kernelOpFromString(const std::string& operatorStr)
+        {
+            if (operatorStr == "+")
+                return STP_KernelOp::ADD;
+            if (operatorStr == "-")
+                return STP_KernelOp::SUB;
+            if (operatorStr == ".*")
+                return STP_KernelOp::MUL;
+            if (operatorStr == "./")
+                return STP_KernelOp::DIV;
+            if (operatorStr == ">")
+                return STP_KernelOp::GT;
+            if (operatorStr == "<")
+                return STP_KernelOp::LT;
+            if (operatorStr == ">=")
+                return STP_KernelOp::GE;
+            if (operatorStr == "<=")
+                return STP_KernelOp::LE;
+            return std::nullopt;
+        }
+    } // namespace
+
+    std::optional<STP_DenseMatrix> STP_toDenseMatrix(const Matrix& matrix)
+    {
+        const auto& data = matrix.getData();
+
+        STP_DenseMatrix dense;
+        dense.rows = data.size();
+        dense.cols = data.empty() ? 0 : data.front().size();
+        dense.values.reserve(dense.rows * dense.cols);
+
+        for (const auto& row : data)
+        {
+            if (row.size() != dense.cols)
+                return std::nullopt;
+            for (const auto& number : row)
+            {
+                double value = 0.0;
+                bool exact = false;
+                if (not parseNumber(number, value, exact))
+                    return std::nullopt;
+                dense.integral = dense.integral and exact;
+                dense.values.emplace_back(value);
+            }
+        }
+        return dense;
+    }
+
+    std::shared_ptr<const STP_DenseMatrix> STP_getDenseMatrix(const Matrix& matrix, STP_DenseCache* cache)
+    {
+        const auto convert = [&]() -> std::shared_ptr<const STP_DenseMatrix> {
+            auto dense = STP_toDenseMatrix(matrix);
+            if (not dense)
+                return nullptr;
+            return std::make_shared<const STP_DenseMatrix>(std::move(*dense));
+        };
+        if (cache == nullptr)
+            return convert();
+
+        // Failed conversions are remembered too, so matrices of decimals are only checked once.
+        std::scoped_lock lock(cache->mutex);
+        if (not cache->converted)
+        {
+            cache->dense = convert();
+            cache->converted = true;
+        }
+        return cache->dense;
+    }
+
+    Matrix STP_fromDenseMatrix(const STP_DenseMatrix& matrix)
+    {
+        MatVec2D<Number> data;
+        data.reserve(matrix.rows);
+        for (size_t i = 0; i < matrix.rows; i++)
+        {
+            std::vector<Number> row;
+            row.reserve(matrix.cols);
+            for (size_t j = 0; j < matrix.cols; j++)
+            {
+                const double value = matrix.values[(i * matrix.cols) + j];
+                STP_FastNumber number{ .kind = STP_FastNumber::Kind::REAL, .real = value };
+                if (matrix.integral)
+                    number = { .kind = STP_FastNumber::Kind::INTEGER, .integer = static_cast<int64_t>(value) };
+                row.emplace_back(STP_fastToNumber(number));
+            }
+            data.emplace_back(std::move(row));
+        }
+        return Matrix(data);
+    }
+
+    const char* STP_kernelIsaName()
+    {
+        switch (detectIsa())
+        {
+        case Isa::AVX2:
+            return "avx2";
+        case Isa::SSE2:
+            return "sse2";
+        default:
+            return "scalar";
+        }
+    }
+
+    bool STP_kernelElementWise(
+        const STP_KernelOp op, const double* lhs, const double* rhs, double* out, const size_t count)
+    {
+        switch (op)
+        {
+        case STP_KernelOp::ADD:
+            return elementWiseDispatch<STP_KernelOp::ADD>(lhs, rhs, out, count);
+        case STP_KernelOp::SUB:
+            return elementWiseDispatch<STP_KernelOp::SUB>(lhs, rhs, out, count);
+        case STP_KernelOp::MUL:
+            return elementWiseDispatch<STP_KernelOp::MUL>(lhs, rhs, out, count);
+        case STP_KernelOp::DIV:
+            return elementWiseDispatch<STP_KernelOp::DIV>(lhs, rhs, out, count);
+        case STP_KernelOp::GT:
+            return elementWiseDispatch<STP_KernelOp::GT>(lhs, rhs, out, count);
+        case STP_KernelOp::LT:
+            return elementWiseDispatch<STP_KernelOp::LT>(lhs, rhs, out, count);
+        case STP_KernelOp::GE:
+            return elementWiseDispatch<STP_KernelOp::GE>(lhs, rhs, out, count);
+        case STP_KernelOp::LE:
+            return elementWiseDispatch<STP_KernelOp::LE>(lhs, rhs, out, count);
+        }
+        return false;
+    }
+
+    bool STP_kernelAllNonZero(const double* values, const size_t count)
+    {
+#ifdef STP_KERNELS_X86
+        if (detectIsa() == Isa::AVX2)
+            return allNonZeroAvx2(values, count);
+#endif
+        for (size_t i = 0; i < count; i++)
+            if (values[i] == 0.0)
+                return false;
+        return true;
+    }
+
+    bool STP_kernelEqual(const double* lhs, const double* rhs, const size_t count)
+    {
+#ifdef STP_KERNELS_X86
+        if (detectIsa() == Isa::AVX2)
+            return equalAvx2(lhs, rhs, count);
+#endif
+        for (size_t i = 0; i < count; i++)
+            if (lhs[i] != rhs[i])
+                return false;
+        return true;
+    }
+
+    bool STP_kernelDot(const double* lhs, const double* rhs, const size_t count, double& result)
+    {
+#ifdef STP_KERNELS_X86
+        if (detectIsa() == Isa::AVX2)
+            return dotAvx2(lhs, rhs, count, result);
+#endif
+        return dotScalar(lhs, rhs, count, result);
+    }
+
+    std::optional<STP_DenseMatrix> STP_kernelGemm(const STP_DenseMatrix& lhs,
+                                                  const STP_DenseMatrix& rhs,
+                                                  const STP_CancelToken& cancel)
+    {
+        STP_DenseMatrix out{ .rows = lhs.rows, .cols = rhs.cols, .values = {} };
+        out.values.assign(out.rows * out.cols, 0.0);
+
+        std::atomic<bool> cancelled = false;
+        STP_ThreadPool::shared().parallelFor(0, lhs.rows, GEMM_BLOCK_M, [&](const size_t begin, const size_t end) {
+            // Safepoint. Skipped row blocks are left as zeros, so the whole product is thrown away.
+            if (cancel.isCancelled())
+            {
+                cancelled.store(true, std::memory_order_relaxed);
+                return;
+            }
+            gemmRowBlock(lhs, rhs, out, begin, end);
+        });
+        if (cancelled.load(std::memory_order_relaxed))
+            return std::nullopt;
+        return out;
+    }
+
+    std::optional<STP_KernelResult> STP_applyMatrixKernel(const Matrix& lhs,
+                                                          const std::string& operatorStr,
+                                                          const Matrix& rhs,
+                                                          std::optional<bool>* hasZero,
+                                                          const STP_KernelContext& context)
+    {
+        const auto op = kernelOpFromString(operatorStr);
+        if (not op)
+            return std::nullopt;
+
+        const auto [lhsDense, rhsDense] = getOperands(lhs, rhs, context);
+        if (not lhsDense or lhsDense->rows != rhsDense->rows or lhsDense->cols != rhsDense->cols)
+            return std::nullopt;
+
+        auto result = std::make_shared<STP_DenseMatrix>();
+        result->rows = lhsDense->rows;
+        result->cols = lhsDense->cols;
+        result->values.resize(lhsDense->values.size());
+        double* values = result->values.data();
+        const size_t count = result->values.size();
+        const bool exact = STP_kernelElementWise(*op, lhsDense->values.data(), rhsDense->values.data(), values, count);
+
+        // Comparison masks are always integral.
+        if (not isArithmetic(*op))
+            result->integral = true;
+        else if (not acceptResult(exact and lhsDense->integral and rhsDense->integral, *result, context))
+            return std::nullopt;
+
+        // Comparison masks are often used as conditions, so remember whether they are all true.
+        if (hasZero != nullptr and not isArithmetic(*op))
+            *hasZero = not STP_kernelAllNonZero(values, count);
+        return STP_KernelResult{ .matrix = STP_fromDenseMatrix(*result), .dense = std::move(result) };
+    }
+
+    std::optional<bool> STP_applyEqualityKernel(const Matrix& lhs,
+                                                const Matrix& rhs,
+                                                const STP_KernelContext& context)
+    {
+        const auto [lhsDense, rhsDense] = getOperands(lhs, rhs, context);
+        if (not lhsDense or lhsDense->rows != rhsDense->rows or lhsDense->cols != rhsDense->cols)
+            return std::nullopt;
+
+        // Integral buffers give the same result as `Number`. Rounded decimals are compared as `double` values, as
+        // fast-math mode does for numbers.
+        return STP_kernelEqual(lhsDense->values.data(), rhsDense->values.data(), lhsDense->values.size());
+    }
+
+    std::optional<STP_KernelResult> STP_applyDotKernel(const Matrix& lhs,
+                                                       const Matrix& rhs,
+                                                       const STP_KernelContext& context)
+    {
+        const auto [lhsDense, rhsDense] = getOperands(lhs, rhs, context);
+        if (not lhsDense or lhsDense->rows != 1 or rhsDense->cols != 1 or rhsDense->rows != lhsDense->cols)
+            return std::nullopt;
+
+        auto result = std::make_shared<STP_DenseMatrix>(STP_DenseMatrix{ .rows = 1, .cols = 1, .values = { 0.0 } });
+        const bool exact =
+            STP_kernelDot(lhsDense->values.data(), rhsDense->values.data(), lhsDense->cols, result->values[0]);
+        if (not acceptResult(exact and lhsDense->integral and rhsDense->integral, *result, context))
+            return std::nullopt;
+        return STP_KernelResult{ .matrix = STP_fromDenseMatrix(*result), .dense = std::move(result) };
+    }
+
+    std::optional<STP_KernelResult> STP_applyGemmKernel(const Matrix& lhs,
+                                                        const Matrix& rhs,
+                                                        const STP_KernelContext& context)
+    {
+        const auto& lhsData = lhs.getData();
+        const auto& rhsData = rhs.getData();
+        if (lhsData.empty() or rhsData.empty() or lhsData.front().size() != rhsData.size())
+            return std::nullopt;
+        if (lhsData.size() * rhsData.size() * rhsData.front().size() < STP_GEMM_MIN_WORK)
+            return std::nullopt;
+
+        const auto [lhsDense, rhsDense] = getOperands(lhs, rhs, context);
+        if (not lhsDense)
+            return std::nullopt;
+
+        // Each element is a sum of `inner` products, so this bounds every partial sum.
+        const double bound = maxMagnitude(lhsDense->values) * maxMagnitude(rhsDense->values) *
+                             static_cast<double>(lhsDense->cols);
+        const bool exact = lhsDense->integral and rhsDense->integral and bound < EXACT_LIMIT;
+        if (not exact and not context.allowRounding)
+            return std::nullopt;
+
+        auto product = STP_kernelGemm(*lhsDense, *rhsDense, context.cancel);
+        if (not product)
+            return std::nullopt;
+        auto result = std::make_shared<STP_DenseMatrix>(std::move(*product));
+        if (not acceptResult(exact, *result, context))
+            return std::nullopt;
+        return STP_KernelResult{ .matrix = STP_fromDenseMatrix(*result), .dense = std::move(result) };
+    }
+} // namespace steppable::parser
@@ -0,0 +1,201 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include "stpInterp/stpOptions.hpp"
+
+#include "output.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+using namespace std::literals;
+
+namespace steppable::parser
+{
+    namespace
+    {
+        /// Options that always take a value, which may also be passed as the next argument.
+        constexpr std::array VALUE_OPTIONS = {
+            "--jobs"sv, "--manifest"sv, "--serve"sv, "--snapshot-in"sv, "--snapshot-out"sv,
+        };
+
+        /**
+         * @brief Parse a size in bytes, optionally followed by a `K`, `M` or `G` suffix.
+         *
+         * @param text The text to parse.
+         * @param size The parsed size.
+         * @return True if the size is valid. False otherwise.
+         */
+        bool parseSize(const std::string_view text, size_t& size)
+        {
+            const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), size);
+            if (error != std::errc() or end == text.data())
+                return false;
+
+            const std::string_view suffix(end, text.data() + text.size());
+            size_t shift = 0;
+            if (suffix == "K" or suffix == "k")
+                shift = 10;
+            else if (suffix == "M" or suffix == "m")
+                shift = 20;
+            else if (suffix == "G" or suffix == "g")
+                shift = 30;
+            else if (not suffix.empty())
+                return false;
+
+            if (size == 0 or size > (SIZE_MAX >> shift))
+                return false;
+            size <<= shift;
+            return true;
+        }
+    } // namespace
+
+    bool STP_parseOptions(const int argc, const char** argv, STP_Options& options)
+    {
+        for (int i = 0; i < argc; i++)
+        {
+            const std::string_view arg = argv[i]; // NOLINT(*-pointer-arithmetic)
+            if (i == 0 or not arg.starts_with("--"))
+            {
+                options.positionalArgs.emplace_back(arg);
+                continue;
+            }
+
+            // --name=value
+            const size_t equalsPos = arg.find('=');
+            const std::string_view name = arg.substr(0, equalsPos);
+            std::string_view value = equalsPos == std::string_view::npos ? ""sv : arg.substr(equalsPos + 1);
+
+            // --name value, for options that always take a value
+            const bool takesValue = std::ranges::find(VALUE_OPTIONS, name) != VALUE_OPTIONS.end();
+            if (equalsPos == std::string_view::npos and takesValue and i + 1 < argc)
+                value = argv[++i]; // NOLINT(*-pointer-arithmetic)
+
+            if (arg == "--fast-math")
+                options.fastMath = true;
+            else if (arg == "--stream")
+                options.stream = true;
+            else if (arg == "--watch")
+                options.watch = true;
+            else if (name == "--jobs")
+            {
+                const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), options.jobs);
+                if (error != std::errc() or end != value.data() + value.size() or options.jobs == 0)
+                {
+                    output::error("parser"s, "Invalid number of jobs {0}"s, { std::string(value) });
+                    return false;
+                }
+                options.batch = true;
+            }
+            else if (name == "--manifest")
+            {
+                if (value.empty())
+                {
+                    output::error("parser"s, "Expected a path after --manifest="s);
+                    return false;
+                }
+                options.manifest = value;
+                options.batch = true;
+            }
+            else if (name == "--serve")
+            {
+                if (value.empty())
+                {
+                    output::error("parser"s, "Expected a socket path after --serve="s);
+                    return false;
+                }
+                options.servePath = value;
+            }
+            else if (name == "--snapshot-in" or name == "--snapshot-out")
+            {
+                if (value.empty())
+                {
+                    output::error("parser"s, "Expected a path after {0}="s, { std::string(name) });
+                    return false;
+                }
+                (name == "--snapshot-in" ? options.snapshotIn : options.snapshotOut) = value;
+            }
+            else if (name == "--max-steps")
+            {
+                const auto [end, error] =
+                    std::from_chars(value.data(), value.data() + value.size(), options.limits.maxSteps);
+                if (error != std::errc() or end != value.data() + value.size() or options.limits.maxSteps == 0)
+                {
+                    output::error("parser"s, "Invalid step limit {0}"s, { std::string(value) });
+                    return false;
+                }
+            }
+            else if (name == "--timeout")
+            {
+                const auto [end, error] =
+                    std::from_chars(value.data(), value.data() + value.size(), options.limits.timeoutMs);
+                if (error != std::errc() or end != value.data() + value.size() or options.limits.timeoutMs == 0)
+                {
+                    output::error("parser"s, "Invalid timeout {0}. Expected milliseconds"s, { std::string(value) });
+                    return false;
+                }
+            }
+            else if (name == "--max-value-bytes")
+            {
+                if (not parseSize(value, options.limits.maxValueBytes))
+                {
+                    output::error("parser"s, "Invalid value size limit {0}"s, { std::string(value) });
+                    return false;
+                }
+            }
+            else if (name == "--output-buffer")
+            {
+                if (not parseSize(value, options.outputBufferSize))
+                {
+                    output::error("parser"s, "Invalid output buffer size {0}"s, { std::string(value) });
+                    return false;
+                }
+            }
+            else if (name == "--flush")
+            {
+                if (value == "line")
+                    options.flushPolicy = STP_FlushPolicy::LINE;
+                else if (value == "block")
+                    options.flushPolicy = STP_FlushPolicy::BLOCK;
+                else if (value == "exit")
+                    options.flushPolicy = STP_FlushPolicy::EXIT;
+                else
+                {
+                    output::error("parser"s, "Invalid flush policy {0}. Expected line, block or exit"s, {
+                        std::string(value),
+                    });
+                    return false;
+                }
+            }
+            else
+            {
+                output::error("parser"s, "Unknown option {0}"s, { std::string(arg) });
+                return false;
+            }
+        }
+        return true;
+    }
+} // namespace steppable::parser
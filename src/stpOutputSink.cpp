@@ -0,0 +1,98 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include "stpInterp/stpOutputSink.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace steppable::parser
+{
+    STP_OutputSink::STP_OutputSink(FILE* target, const size_t capacity) : target(target), buffer(capacity) {}
+
+    STP_OutputSink::~STP_OutputSink() { flush(); }
+
+    void STP_OutputSink::write(const std::string_view text)
+    {
+        if (text.size() > buffer.size() - used and policy == STP_FlushPolicy::EXIT)
+            buffer.resize(std::max(buffer.size() * 2, used + text.size()));
+        else if (text.size() > buffer.size() - used)
+        {
+            flush();
+            // Too large to buffer, write it directly.
+            if (text.size() >= buffer.size())
+            {
+                emit(text);
+                return;
+            }
+        }
+        std::memcpy(buffer.data() + used, text.data(), text.size());
+        used += text.size();
+    }
+
+    void STP_OutputSink::writeLine(const std::string_view text)
+    {
+        write(text);
+        write("\n");
+        if (policy == STP_FlushPolicy::LINE)
+            flush();
+    }
+
+    void STP_OutputSink::flush()
+    {
+        if (used != 0)
+            emit({ buffer.data(), used });
+        used = 0;
+        if (not writer)
+            fflush(target);
+    }
+
+    void STP_OutputSink::captureTo(std::string* newCapture)
+    {
+        if (newCapture == nullptr)
+            writeTo(nullptr);
+        else
+            writeTo([newCapture](const std::string_view text) { newCapture->append(text); });
+    }
+
+    void STP_OutputSink::writeTo(STP_OutputWriter newWriter)
+    {
+        flush();
+        writer = std::move(newWriter);
+    }
+
+    void STP_OutputSink::emit(const std::string_view text)
+    {
+        if (writer)
+            writer(text);
+        else
+            fwrite(text.data(), 1, text.size(), target);
+    }
+
+    void STP_OutputSink::setBufferSize(const size_t capacity)
+    {
+        flush();
+        buffer.resize(std::max(capacity, size_t{ 1 }));
+        buffer.shrink_to_fit();
+    }
+} // namespace steppable::parser
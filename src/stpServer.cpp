@@ -0,0 +1,346 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include "stpInterp/stpServer.hpp"
+
+#include "output.hpp"
+#include "stpInterp/stpErrors.hpp"
+#include "stpInterp/stpInit.hpp"
+#include "stpInterp/stpInterrupt.hpp"
+#include "stpInterp/stpProcessor.hpp"
+#include "stpInterp/stpSourceBuffer.hpp"
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define STP_SERVE_SUPPORTED
+    #include <csignal>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <sys/stat.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+extern "C" {
+#include <tree_sitter/api.h>
+}
+
+using namespace std::literals;
+
+extern "C" TSLanguage* tree_sitter_stp();
+
+namespace steppable::parser
+{
+#ifdef STP_SERVE_SUPPORTED
+    namespace
+    {
+        /// How often the accept loop checks for an interrupt, in milliseconds.
+        constexpr int SERVE_POLL_INTERVAL_MS = 250;
+
+        /**
+         * @struct Connection
+         * @brief A connection of the server, and the thread serving it.
+         */
+        struct Connection
+        {
+            int fd = -1; ///< The socket of the connection. Closed by the server after the thread is joined.
+            STP_InterpState state; ///< Warm state of the connection, kept between its requests.
+
+            std::mutex mutex; ///< Guards starting evaluations against cancelling them.
+            bool closing = false; ///< Whether the server is shutting down. No more evaluations are started.
+
+            std::atomic<bool> done = false; ///< Set by the thread when it is done, so that it can be joined.
+            std::thread thread; ///< The thread serving the connection.
+        };
+
+        /**
+         * @brief Read exactly `size` bytes from a socket.
+         *
+         * @param fd The socket.
+         * @param data Where to store the bytes.
+         * @param size Number of bytes to read.
+         * @return True if all bytes are read. False on errors or end of stream.
+         */
+        bool readExact(const int fd, char* data, size_t size)
+        {
+            while (size != 0)
+            {
+                const ssize_t bytesRead = read(fd, data, size);
+                if (bytesRead < 0 and errno == EINTR)
+                    continue;
+                if (bytesRead <= 0)
+                    return false;
+                data += bytesRead; // NOLINT(*-pointer-arithmetic)
+                size -= static_cast<size_t>(bytesRead);
+            }
+            return true;
+        }
+
+        /**
+         * @brief Write all bytes to a socket.
+         *
+         * @param fd The socket.
+         * @param data The bytes to write.
+         * @return True if all bytes are written. False on errors.
+         */
+        bool writeAll(const int fd, std::string_view data)
+        {
+            while (not data.empty())
+            {
+                const ssize_t bytesWritten = write(fd, data.data(), data.size());
+                if (bytesWritten < 0 and errno == EINTR)
+                    continue;
+                if (bytesWritten <= 0)
+                    return false;
+                data.remove_prefix(static_cast<size_t>(bytesWritten));
+            }
+            return true;
+        }
+
+        /**
+         * @brief Append a big-endian 32-bit length and the data to a response.
+         *
+         * @param response The response to append to.
+         * @param data The data.
+         */
+        void appendBlock(std::string& response, const std::string_view data)
+        {
+            const auto size = static_cast<std::uint32_t>(data.size());
+            for (int shift = 24; shift >= 0; shift -= 8)
+                response += static_cast<char>((size >> shift) & 0xFFU);
+            response += data;
+        }
+
+        /**
+         * @brief Evaluate one request in the state of a connection.
+         *
+         * @param source The source code.
+         * @param state The state of the connection.
+         * @param parser The parser of the connection.
+         * @return The status of the response.
+         */
+        STP_ServeStatus evaluate(std::string source, const STP_InterpState& state, TSParser* parser)
+        {
+            TSTree* tree = nullptr;
+            try
+            {
+                const auto buffer = std::make_shared<const STP_SourceBuffer>(std::move(source));
+                const std::string_view text = buffer->view();
+
+                tree = ts_parser_parse_string(parser, nullptr, text.data(), static_cast<uint32_t>(text.size()));
+                const TSNode rootNode = ts_tree_root_node(tree);
+                state->setChunk(buffer);
+                if (not STP_checkRecursiveNodeSanity(rootNode, state))
+                    STP_processChunkChild(rootNode, state);
+            }
+            catch (const std::exception& exception)
+            {
+                state->setError(exception.what());
+            }
+
+            state->getOutput().flush();
+
+            // Functions declared by the request own a copy of the tree and keep its text, so that later requests on
+            // the connection can call them after the tree of this request is deleted.
+            if (tree != nullptr)
+                ts_tree_delete(tree);
+
+            if (state->getLimitHit() != STP_LimitKind::NONE)
+                return STP_ServeStatus::LIMIT;
+            return state->getError().empty() ? STP_ServeStatus::OK : STP_ServeStatus::ERROR;
+        }
+
+        /**
+         * @brief Serve the requests of one connection, until it is closed or the server shuts down.
+         *
+         * @param connection The connection.
+         */
+        void serveConnection(Connection& connection)
+        {
+            const int fd = connection.fd;
+            const STP_InterpState& state = connection.state;
+
+            std::string output;
+            state->getOutput().captureTo(&output);
+
+            TSParser* parser = ts_parser_new();
+            ts_parser_set_language(parser, tree_sitter_stp());
+
+            std::array<unsigned char, 4> header{};
+            while (readExact(fd, reinterpret_cast<char*>(header.data()), header.size())) // NOLINT(*-reinterpret-cast)
+            {
+                const std::uint32_t size = (static_cast<std::uint32_t>(header[0]) << 24U) |
+                                           (static_cast<std::uint32_t>(header[1]) << 16U) |
+                                           (static_cast<std::uint32_t>(header[2]) << 8U) |
+                                           static_cast<std::uint32_t>(header[3]);
+                if (size > STP_SERVE_REQUEST_LIMIT)
+                    break;
+
+                std::string source(size, '\0');
+                if (not readExact(fd, source.data(), size))
+                    break;
+
+                {
+                    const std::lock_guard lock(connection.mutex);
+                    if (connection.closing)
+                        break;
+                    state->clearError();
+                    state->setExecState(STP_ExecState::NORMAL);
+                    state->startEvaluation();
+                }
+
+                output.clear();
+                const STP_ServeStatus status = evaluate(std::move(source), state, parser);
+
+                std::string response;
+                response.reserve(1 + 4 + output.size() + 4 + state->getError().size());
+                response += static_cast<char>(status);
+                appendBlock(response, output);
+                appendBlock(response, state->getError());
+                if (not writeAll(fd, response) or state->getExecState() == STP_ExecState::EXIT)
+                    break;
+            }
+
+            state->getOutput().captureTo(nullptr);
+            ts_parser_delete(parser);
+            connection.done = true;
+        }
+
+        /**
+         * @brief Join the thread of a connection and close its socket.
+         *
+         * @param connection The connection. Its thread must be done, or about to be.
+         */
+        void closeConnection(Connection& connection)
+        {
+            connection.thread.join();
+            close(connection.fd);
+        }
+    } // namespace
+
+    int STP_runServer(const std::string& socketPath, const STP_Options& options)
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (socketPath.size() >= sizeof(address.sun_path))
+        {
+            output::error("parser"s, "Socket path {0} is too long"s, { socketPath });
+            return 1;
+        }
+        std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+        // Replace a socket left over by a previous server, but never another kind of file.
+        if (struct stat fileStat{}; lstat(socketPath.c_str(), &fileStat) == 0 and S_ISSOCK(fileStat.st_mode))
+            unlink(socketPath.c_str());
+
+        const int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd < 0 or
+            bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 or // NOLINT(*-reinterpret-cast)
+            listen(listenFd, SOMAXCONN) != 0)
+        {
+            output::error("parser"s, "Unable to listen on {0}: {1}"s, { socketPath, std::strerror(errno) });
+            if (listenFd >= 0)
+                close(listenFd);
+            return 1;
+        }
+
+        // A client that goes away must not kill the server.
+        (void)std::signal(SIGPIPE, SIG_IGN);
+        STP_installInterruptHandler();
+        output::info("parser"s, "Serving on {0}"s, { socketPath });
+
+        std::vector<std::unique_ptr<Connection>> connections;
+        while (not STP_isInterruptRequested())
+        {
+            std::erase_if(connections, [](const std::unique_ptr<Connection>& connection) {
+                if (not connection->done)
+                    return false;
+                closeConnection(*connection);
+                return true;
+            });
+
+            // Leave new connections waiting in the backlog until one is closed.
+            if (connections.size() >= STP_SERVE_CONNECTION_LIMIT)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(SERVE_POLL_INTERVAL_MS));
+                continue;
+            }
+
+            pollfd pollFd{ .fd = listenFd, .events = POLLIN, .revents = 0 };
+            if (poll(&pollFd, 1, SERVE_POLL_INTERVAL_MS) <= 0)
+                continue;
+
+            const int fd = accept(listenFd, nullptr, nullptr);
+            if (fd < 0)
+                continue;
+
+            auto& connection = connections.emplace_back(std::make_unique<Connection>());
+            connection->fd = fd;
+            connection->state = STP_createState();
+            connection->state->setEmbedded();
+            connection->state->setFile("<serve>");
+            if (options.fastMath)
+                connection->state->setFastMath();
+            connection->state->setLimits(options.limits);
+            connection->thread = std::thread(serveConnection, std::ref(*connection));
+        }
+
+        // The interrupt only shuts the server down. Running evaluations are cancelled one by one, and the flag is
+        // cleared so that it does not outlive the server.
+        STP_clearInterrupt();
+        for (const auto& connection : connections)
+        {
+            {
+                const std::lock_guard lock(connection->mutex);
+                connection->closing = true;
+                connection->state->requestCancel();
+            }
+            // Wake the thread if it waits for a request.
+            shutdown(connection->fd, SHUT_RDWR);
+        }
+        for (const auto& connection : connections)
+            closeConnection(*connection);
+
+        close(listenFd);
+        unlink(socketPath.c_str());
+        return 0;
+    }
+#else
+    int STP_runServer(const std::string& socketPath, const STP_Options& /*options*/)
+    {
+        output::error("parser"s, "Serving on {0} is not supported on this platform"s, { socketPath });
+        return 1;
+    }
+#endif
+} // namespace steppable::parser
@@ -0,0 +1,366 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include "stpInterp/stpSnapshot.hpp"
+
+#include "output.hpp"
+#include "steppable/mat2d.hpp"
+#include "steppable/number.hpp"
+#include "stpInterp/stpErrors.hpp"
+#include "stpInterp/stpFastMath.hpp"
+#include "stpInterp/stpProcessor.hpp"
+#include "stpInterp/stpSourceBuffer.hpp"
+
+#include <algorithm>
+#include <any>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+
+namespace steppable::parser
+{
+    namespace
+    {
+        /// Magic bytes at the start of every snapshot file.
+        constexpr std::string_view SNAPSHOT_MAGIC = "STPSNAP"sv;
+
+        /// Version of the snapshot format. Snapshots of other versions are rejected.
+        constexpr std::uint32_t SNAPSHOT_VERSION = 1;
+
+        /**
+         * @enum SnapshotKind
+         * @brief Kind of a value stored in a snapshot. Kept apart from `STP_TypeID`, so that the format is stable.
+         */
+        enum class SnapshotKind : std::uint8_t
+        {
+            NONE = 0,
+            NUMBER = 1,
+            FAST_NUMBER = 2,
+            MATRIX = 3,
+            STRING = 4,
+            SYMBOL = 5,
+        };
+
+        /**
+         * @brief Append a little-endian 32-bit integer to a snapshot.
+         *
+         * @param out The snapshot being written.
+         * @param value The integer.
+         */
+        void writeU32(std::string& out, const std::uint32_t value)
+        {
+            for (int shift = 0; shift < 32; shift += 8)
+                out += static_cast<char>((value >> shift) & 0xFFU);
+        }
+
+        /**
+         * @brief Append a string, prefixed with its length, to a snapshot.
+         *
+         * @param out The snapshot being written.
+         * @param value The string.
+         */
+        void writeString(std::string& out, const std::string_view value)
+        {
+            writeU32(out, static_cast<std::uint32_t>(value.size()));
+            out += value;
+        }
+
+        /**
+         * @brief Append a value to a snapshot.
+         *
+         * @param out The snapshot being written.
+         * @param value The value.
+         * @return True if the value is written. False if its type cannot be saved.
+         */
+        bool writeValue(std::string& out, const STP_Value& value)
+        {
+            if (value.isFuture())
+                return false;
+
+            std::string payload;
+            SnapshotKind kind = SnapshotKind::NONE;
+            if (value.isFastNumber())
+            {
+                kind = SnapshotKind::FAST_NUMBER;
+                writeString(payload, STP_presentFastNumber(value.fastNumber));
+            }
+            else
+            {
+                switch (value.typeID)
+                {
+                case STP_TypeID::NONE:
+                    break;
+                case STP_TypeID::NUMBER:
+                    kind = SnapshotKind::NUMBER;
+                    writeString(payload, std::any_cast<Number>(value.data).present());
+                    break;
+                case STP_TypeID::MATRIX_2D:
+                {
+                    kind = SnapshotKind::MATRIX;
+                    const auto& matrix = std::any_cast<const Matrix&>(value.data);
+                    writeU32(payload, static_cast<std::uint32_t>(matrix.getRows()));
+                    writeU32(payload, static_cast<std::uint32_t>(matrix.getCols()));
+                    for (const auto& row : matrix.getData())
+                        for (const auto& number : row)
+                            writeString(payload, number.present());
+                    break;
+                }
+                case STP_TypeID::STRING:
+                    kind = SnapshotKind::STRING;
+                    writeString(payload, std::any_cast<const std::string&>(value.data));
+                    break;
+                case STP_TypeID::SYMBOL:
+                    kind = SnapshotKind::SYMBOL;
+                    writeString(payload, std::any_cast<const std::string&>(value.data));
+                    break;
+                default:
+                    return false;
+                }
+            }
+
+            out += static_cast<char>(value.getIsConstant());
+            out += static_cast<char>(kind);
+            out += payload;
+            return true;
+        }
+
+        /**
+         * @class SnapshotReader
+         * @brief Reads the fields of a snapshot in order. Reads past the end give empty fields and mark the reader
+         * as failed.
+         */
+        class SnapshotReader
+        {
+            std::string_view data;
+            bool failed = false;
+
+        public:
+            explicit SnapshotReader(const std::string_view data) : data(data) {}
+
+            [[nodiscard]] bool hasFailed() const { return failed; }
+
+            [[nodiscard]] bool atEnd() const { return data.empty(); }
+
+            /**
+             * @brief Read a number of raw bytes.
+             *
+             * @param size Number of bytes to read.
+             * @return The bytes, pointing into the snapshot.
+             */
+            std::string_view readBytes(const size_t size)
+            {
+                if (failed or size > data.size())
+                {
+                    failed = true;
+                    return {};
+                }
+                const std::string_view bytes = data.substr(0, size);
+                data.remove_prefix(size);
+                return bytes;
+            }
+
+            std::uint8_t readU8()
+            {
+                const std::string_view bytes = readBytes(1);
+                return bytes.empty() ? 0 : static_cast<std::uint8_t>(bytes[0]);
+            }
+
+            std::uint32_t readU32()
+            {
+                const std::string_view bytes = readBytes(4);
+                std::uint32_t value = 0;
+                for (size_t i = 0; i < bytes.size(); i++)
+                    value |= static_cast<std::uint32_t>(static_cast<unsigned char>(bytes[i])) << (i * 8);
+                return value;
+            }
+
+            std::string_view readString() { return readBytes(readU32()); }
+
+            /**
+             * @brief Read a value written by `writeValue()`.
+             * @return The value, or `std::nullopt` if the value is malformed.
+             */
+            std::optional<STP_Value> readValue()
+            {
+                const bool isConstant = readU8() != 0;
+                switch (static_cast<SnapshotKind>(readU8()))
+                {
+                case SnapshotKind::NONE:
+                    return STP_Value(STP_TypeID::NONE, std::any{}, isConstant);
+                case SnapshotKind::FAST_NUMBER:
+                {
+                    const std::string_view literal = readString();
+                    if (const auto fastNumber = STP_parseFastNumber(literal); fastNumber and not isConstant)
+                        return STP_Value(*fastNumber);
+                    return STP_Value(STP_TypeID::NUMBER, Number(std::string(literal)), isConstant);
+                }
+                case SnapshotKind::NUMBER:
+                    return STP_Value(STP_TypeID::NUMBER, Number(std::string(readString())), isConstant);
+                case SnapshotKind::MATRIX:
+                {
+                    const std::uint32_t rows = readU32();
+                    const std::uint32_t cols = readU32();
+                    // Each number takes at least its length prefix, so a malformed size cannot allocate too much.
+                    if (failed or static_cast<std::uint64_t>(rows) * cols * 4 > data.size())
+                        return std::nullopt;
+
+                    MatVec2D<Number> matrix(rows, std::vector<Number>(cols));
+                    for (auto& row : matrix)
+                        for (auto& number : row)
+                            number = Number(std::string(readString()));
+                    return STP_Value(STP_TypeID::MATRIX_2D, Matrix(matrix), isConstant);
+                }
+                case SnapshotKind::STRING:
+                    return STP_Value(STP_TypeID::STRING, std::string(readString()), isConstant);
+                case SnapshotKind::SYMBOL:
+                {
+                    STP_Value value(STP_TypeID::SYMBOL, std::string(readString()), isConstant);
+                    value.typeName = STP_typeNames.at(STP_TypeID::SYMBOL);
+                    return value;
+                }
+                default:
+                    return std::nullopt;
+                }
+            }
+        };
+    } // namespace
+
+    bool STP_saveSnapshot(const std::string& path, const STP_InterpState& state)
+    {
+        const STP_Scope* globalScope = state->getGlobalScope();
+
+        // Sort the variables, so that the same scope always gives the same snapshot.
+        std::vector<const std::pair<const std::string, STP_Value>*> variables;
+        variables.reserve(globalScope->variables.size());
+        for (const auto& variable : globalScope->variables)
+            variables.emplace_back(&variable);
+        std::ranges::sort(variables, {}, [](const auto* variable) { return variable->first; });
+
+        std::string variablesOut;
+        std::uint32_t variableCount = 0;
+        for (const auto* variable : variables)
+        {
+            std::string entry;
+            writeString(entry, variable->first);
+            if (not writeValue(entry, variable->second))
+            {
+                output::warning("parser"s, "Variable {0} cannot be saved in a snapshot"s, { variable->first });
+                continue;
+            }
+            variablesOut += entry;
+            variableCount++;
+        }
+
+        std::string out;
+        out += SNAPSHOT_MAGIC;
+        writeU32(out, SNAPSHOT_VERSION);
+        writeU32(out, variableCount);
+        out += variablesOut;
+        // `functions` is a `std::map`, so functions are written sorted by name as well.
+        writeU32(out, static_cast<std::uint32_t>(globalScope->functions.size()));
+        for (const auto& [name, fn] : globalScope->functions)
+            writeString(out, fn.source);
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (not file or not file.write(out.data(), static_cast<std::streamsize>(out.size())))
+        {
+            output::error("parser"s, "Unable to write snapshot {0}"s, { path });
+            return false;
+        }
+        return true;
+    }
+
+    bool STP_loadSnapshot(const std::string& path, const STP_InterpState& state, TSParser* parser)
+    {
+        const std::shared_ptr<const STP_SourceBuffer> snapshot = STP_SourceBuffer::fromFile(path);
+        if (snapshot == nullptr)
+        {
+            output::error("parser"s, "Unable to open snapshot {0}"s, { path });
+            return false;
+        }
+
+        SnapshotReader reader(snapshot->view());
+        if (reader.readBytes(SNAPSHOT_MAGIC.size()) != SNAPSHOT_MAGIC or reader.readU32() != SNAPSHOT_VERSION)
+        {
+            output::error("parser"s, "{0} is not a snapshot of this version"s, { path });
+            return false;
+        }
+
+        // Nothing is added to the scope until the whole snapshot is read, so that a corrupted one changes nothing.
+        std::vector<std::pair<std::string, STP_Value>> variables;
+        const std::uint32_t variableCount = reader.readU32();
+        for (std::uint32_t i = 0; i < variableCount and not reader.hasFailed(); i++)
+        {
+            std::string name(reader.readString());
+            std::optional<STP_Value> value = reader.readValue();
+            if (not value)
+                break;
+            variables.emplace_back(std::move(name), std::move(*value));
+        }
+
+        // Declare all functions in one chunk. Each function keeps the chunk text and its own copy of the tree.
+        std::string functionsSource;
+        const std::uint32_t functionCount = reader.readU32();
+        for (std::uint32_t i = 0; i < functionCount and not reader.hasFailed(); i++)
+        {
+            functionsSource += reader.readString();
+            functionsSource += '\n';
+        }
+
+        if (reader.hasFailed() or not reader.atEnd())
+        {
+            output::error("parser"s, "Snapshot {0} is corrupted"s, { path });
+            return false;
+        }
+
+        TSTree* tree = nullptr;
+        if (functionCount != 0)
+        {
+            const auto buffer = std::make_shared<const STP_SourceBuffer>(std::move(functionsSource));
+            const std::string_view text = buffer->view();
+            tree = ts_parser_parse_string(parser, nullptr, text.data(), static_cast<uint32_t>(text.size()));
+            state->setChunk(buffer);
+            if (STP_checkRecursiveNodeSanity(ts_tree_root_node(tree), state))
+            {
+                ts_tree_delete(tree);
+                return false;
+            }
+        }
+
+        STP_Scope* globalScope = state->getGlobalScope();
+        for (const auto& [name, value] : variables)
+            globalScope->addVariable(name, value);
+        if (tree != nullptr)
+        {
+            STP_processChunkChild(ts_tree_root_node(tree), state);
+            ts_tree_delete(tree);
+        }
+        return true;
+    }
+} // namespace steppable::parser
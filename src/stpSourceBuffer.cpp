@@ -0,0 +1,191 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include "stpInterp/stpSourceBuffer.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <utility>
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
+namespace steppable::parser
+{
+    STP_SourceBuffer::STP_SourceBuffer(std::string text) : owned(std::move(text))
+    {
+        begin = owned.data();
+        size = owned.size();
+    }
+
+    STP_SourceBuffer::~STP_SourceBuffer()
+    {
+#if not defined(_WIN32)
+        if (mapping != nullptr)
+            munmap(mapping, size);
+#endif
+    }
+
+    std::shared_ptr<STP_SourceBuffer> STP_SourceBuffer::fromFile(const std::string& path)
+    {
+        // Not `std::make_shared`, as the default constructor is private.
+        auto buffer = std::shared_ptr<STP_SourceBuffer>(new STP_SourceBuffer());
+
+#if not defined(_WIN32)
+        const int fd = open(path.c_str(), O_RDONLY); // NOLINT(*-vararg)
+        if (fd < 0)
+            return nullptr;
+
+        struct stat fileStat{};
+        if (fstat(fd, &fileStat) == 0 and S_ISREG(fileStat.st_mode) and fileStat.st_size > 0)
+        {
+            const auto fileSize = static_cast<size_t>(fileStat.st_size);
+            void* mapping = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED)
+            {
+                // The file is parsed from start to end.
+                (void)madvise(mapping, fileSize, MADV_SEQUENTIAL);
+                close(fd);
+
+                buffer->mapping = mapping;
+                buffer->begin = static_cast<const char*>(mapping);
+                buffer->size = fileSize;
+                return buffer;
+            }
+        }
+        close(fd);
+#endif
+
+        // Fall back to reading the whole file, e.g., for empty files, pipes or on Windows.
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+        if (not file)
+            return nullptr;
+        buffer->owned.assign(std::istreambuf_iterator(file), std::istreambuf_iterator<char>());
+        buffer->begin = buffer->owned.data();
+        buffer->size = buffer->owned.size();
+        return buffer;
+    }
+
+    std::shared_ptr<STP_SourceBuffer> STP_SourceBuffer::fromStream(FILE* stream)
+    {
+        std::string text;
+        size_t used = 0;
+        while (true)
+        {
+            if (text.size() - used < STP_STREAM_BLOCK_SIZE)
+                text.resize(std::max(text.size() * 2, used + STP_STREAM_BLOCK_SIZE));
+
+            const size_t bytesRead = fread(text.data() + used, 1, text.size() - used, stream);
+            used += bytesRead;
+            if (bytesRead == 0)
+                break;
+        }
+        text.resize(used);
+        if (not text.empty() and text.back() != '\n')
+            text += '\n';
+
+        return std::make_shared<STP_SourceBuffer>(std::move(text));
+    }
+
+    size_t STP_findFirstNonUtf8(const std::string_view text)
+    {
+        const auto* bytes = reinterpret_cast<const uint8_t*>(text.data()); // NOLINT(*-reinterpret-cast)
+        const size_t size = text.size();
+        size_t i = 0;
+
+        while (i < size)
+        {
+            // Skip ASCII characters in blocks.
+#if defined(__SSE2__)
+            while (i + 16 <= size)
+            {
+                const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i)); // NOLINT
+                if (_mm_movemask_epi8(block) != 0)
+                    break;
+                i += 16;
+            }
+#else
+            while (i + 8 <= size)
+            {
+                uint64_t block = 0;
+                std::memcpy(&block, bytes + i, sizeof(block));
+                if ((block & 0x8080808080808080ULL) != 0)
+                    break;
+                i += 8;
+            }
+#endif
+            if (i >= size)
+                break;
+
+            const uint8_t lead = bytes[i];
+            if (lead < 0x80)
+            {
+                i++;
+                continue;
+            }
+
+            // Length of the sequence, and the valid range of the second byte.
+            size_t length = 0;
+            uint8_t secondMin = 0x80;
+            uint8_t secondMax = 0xBF;
+            if (lead >= 0xC2 and lead <= 0xDF)
+                length = 2;
+            else if (lead >= 0xE0 and lead <= 0xEF)
+            {
+                length = 3;
+                if (lead == 0xE0)
+                    secondMin = 0xA0; // Overlong
+                else if (lead == 0xED)
+                    secondMax = 0x9F; // Surrogates
+            }
+            else if (lead >= 0xF0 and lead <= 0xF4)
+            {
+                length = 4;
+                if (lead == 0xF0)
+                    secondMin = 0x90; // Overlong
+                else if (lead == 0xF4)
+                    secondMax = 0x8F; // Above U+10FFFF
+            }
+            else
+                return i;
+
+            if (i + length > size or bytes[i + 1] < secondMin or bytes[i + 1] > secondMax)
+                return i;
+            for (size_t j = 2; j < length; j++)
+                if ((bytes[i + j] & 0xC0) != 0x80)
+                    return i;
+            i += length;
+        }
+        return size;
+    }
+} // namespace steppable::parser
@@ -26,11 +26,13 @@
 #include "steppable/number.hpp"
 #include "stpInterp/stpApplyOperator.hpp"
 #include "stpInterp/stpErrors.hpp"
+#include "stpInterp/stpFuture.hpp"
 #include "util.hpp"
 
 #include <any>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <ranges>
 #include <string>
 #include <utility>
@@ -98,43 +100,81 @@ namespace steppable::parser
 
     STP_Value STP_Value::applyBinaryOperator(const TSNode* node,
                                              const std::string& _operatorStr,
-                                             const STP_Value& rhs) const
+                                             const STP_Value& rhs,
+                                             const STP_InterpState& state) const
     {
         std::string operatorStr = _operatorStr;
         operatorStr = stringUtils::bothEndsReplace(operatorStr, ' ');
 
+        if (isFastNumber() and rhs.isFastNumber())
+        {
+            STP_FastNumber result;
+            if (STP_applyFastBinaryOperator(fastNumber, operatorStr, rhs.fastNumber, result))
+                return STP_Value(result);
+        }
+        // Only convert the fast side, so that a matrix or string on the other side is not copied.
+        if (isFastNumber())
+            return materialized().applyBinaryOperator(node, operatorStr, rhs, state);
+        if (rhs.isFastNumber())
+            return applyBinaryOperator(node, operatorStr, rhs.materialized(), state);
+
         STP_TypeID lhsType = this->typeID;
         STP_TypeID rhsType = rhs.typeID;
         STP_Value returnVal(STP_TypeID::NONE);
 
         const std::unique_ptr<STP_TypeID> typeIdPtr =
-            determineBinaryOperationFeasibility(node, lhsType, operatorStr, rhsType);
+            determineBinaryOperationFeasibility(node, lhsType, operatorStr, rhsType, state);
         if (typeIdPtr == nullptr)
             return returnVal;
 
         STP_TypeID retType = *typeIdPtr;
 
-        std::any value = this->data;
-        std::any rhsValue = rhs.data;
-
         returnVal.typeID = retType;
         returnVal.typeName = STP_typeNames.at(retType);
 
-        std::any returnValueAny = performBinaryOperation(node, lhsType, value, operatorStr, rhsType, rhsValue);
+        STP_MatrixHints hints;
+        hints.lhsDense = denseCache.get();
+        hints.rhsDense = rhs.denseCache.get();
+        std::any returnValueAny =
+            performBinaryOperation(node, lhsType, this->data, operatorStr, rhsType, rhs.data, state, &hints);
 
         if (not returnValueAny.has_value())
-            STP_throwError(*node, STP_getState(), "This operation is not supported at present"s);
-        returnVal.data = returnValueAny;
+        {
+            // Operations that are interrupted give no value either.
+            if (state->shouldStop())
+                return STP_Value(STP_TypeID::NONE);
+            STP_throwError(*node, state, "This operation is not supported at present"s);
+        }
+        returnVal.data = std::move(returnValueAny);
+        returnVal.matrixHasZero = hints.hasZero;
+        returnVal.resetDenseCache();
+
+        // Results of the vectorised kernels are already dense, so chained operations skip the conversion.
+        if (retType == STP_TypeID::MATRIX_2D and hints.resultDense)
+        {
+            returnVal.denseCache->converted = true;
+            returnVal.denseCache->dense = std::move(hints.resultDense);
+        }
 
         return returnVal;
     }
 
-    STP_Value STP_Value::applyUnaryOperator(const TSNode* node, const std::string& _operatorStr) const
+    STP_Value STP_Value::applyUnaryOperator(const TSNode* node,
+                                            const std::string& _operatorStr,
+                                            const STP_InterpState& state) const
     {
         std::string operatorStr = _operatorStr;
         operatorStr = stringUtils::bothEndsReplace(operatorStr, ' ');
 
-        const std::any returnValAny = performUnaryOperation(node, typeID, operatorStr, data);
+        if (isFastNumber())
+        {
+            STP_FastNumber result;
+            if (STP_applyFastUnaryOperator(operatorStr, fastNumber, result))
+                return STP_Value(result);
+            return materialized().applyUnaryOperator(node, operatorStr, state);
+        }
+
+        const std::any returnValAny = performUnaryOperation(node, typeID, operatorStr, data, state);
         if (not returnValAny.has_value())
             return STP_Value(STP_TypeID::NONE);
 
@@ -142,7 +182,7 @@ namespace steppable::parser
         return returnValue;
     }
 
-    bool STP_Value::asBool(const TSNode* node) const
+    bool STP_Value::asBool(const TSNode* node, const STP_InterpState& state) const
     {
         switch (typeID)
         {
@@ -150,13 +190,19 @@ namespace steppable::parser
             return false;
         case STP_TypeID::NUMBER:
         {
+            if (isFastNumber())
+                return fastNumber.asReal() != 0.0;
             const auto val = std::any_cast<Number>(data);
             return val != 0;
         }
         case STP_TypeID::MATRIX_2D:
         {
-            const auto val = std::any_cast<Matrix>(data);
-            return std::ranges::all_of(val.getData(), [](const std::vector<Number>& vec) {
+            if (matrixHasZero)
+                return not *matrixHasZero;
+
+            // Borrow the matrix instead of copying it; `all_of` stops at the first zero.
+            const auto* val = std::any_cast<Matrix>(&data);
+            return std::ranges::all_of(val->getData(), [](const std::vector<Number>& vec) {
                 return std::ranges::all_of(vec, [](const Number& n) { return n != 0; });
             });
         }
@@ -168,7 +214,7 @@ namespace steppable::parser
         default:
         {
             STP_throwError(*node,
-                           STP_getState(),
+                           state,
                            format::format("Cannot convert {0} to a logical type"s,
                                                        {
                                                            STP_typeNames.at(typeID),
@@ -178,6 +224,36 @@ namespace steppable::parser
         }
     }
 
+    void STP_Value::materialize()
+    {
+        if (not isFastNumber())
+            return;
+
+        data = STP_fastToNumber(fastNumber);
+        fastNumber = {};
+    }
+
+    STP_Value STP_Value::materialized() const&
+    {
+        STP_Value value = *this;
+        value.materialize();
+        return value;
+    }
+
+    STP_Value STP_Value::materialized() &&
+    {
+        materialize();
+        return std::move(*this);
+    }
+
+    std::string STP_Value::presentMaterialized(const std::string& name, const bool printName) const
+    {
+        // `materialized()` copies the value, which is costly for large matrices.
+        if (isFastNumber())
+            return materialized().present(name, printName);
+        return present(name, printName);
+    }
+
     void STP_Scope::addVariable(const std::string& name, const STP_Value& data)
     {
         auto *currentScope = this;
@@ -194,35 +270,47 @@ namespace steppable::parser
         variables.insert_or_assign(name, data);
     }
 
-    STP_Value STP_Scope::getVariable(const TSNode* node, const std::string& name)
+    STP_Value STP_Scope::getVariable(const TSNode* node, const std::string& name, const STP_InterpState& state)
     {
         if (not variables.contains(name))
         {
             if (parentScope == nullptr)
             {
-                STP_throwError(
-                    *node, STP_getState(), format::format("Variable {0} is not defined"s, { name }));
+                STP_throwError(*node, state, format::format("Variable {0} is not defined"s, { name }));
                 return STP_Value(STP_TypeID::NONE, nullptr);
             }
-            return parentScope->getVariable(node, name);
+            return parentScope->getVariable(node, name, state);
         }
-        return variables.at(name);
+        // Futures are resolved once, when first read.
+        STP_Value& value = variables.at(name);
+        if (value.isFuture())
+            value = STP_resolveFuture(value, node, state);
+        return value;
+    }
+
+    STP_Value* STP_Scope::findVariable(const std::string& name)
+    {
+        for (auto* scope = this; scope != nullptr; scope = scope->parentScope)
+            if (const auto it = scope->variables.find(name); it != scope->variables.end())
+                return &it->second;
+        return nullptr;
     }
 
     void STP_Scope::addFunction(const std::string& name, const STP_FunctionDefinition& fn) { functions[name] = fn; }
 
-    STP_FunctionDefinition STP_Scope::getFunction(const TSNode* node, const std::string& name)
+    STP_FunctionDefinition STP_Scope::getFunction(const TSNode* node,
+                                                  const std::string& name,
+                                                  const STP_InterpState& state)
     {
         if (functions.contains(name))
             return functions[name];
 
         if (parentScope == nullptr)
         {
-            STP_throwError(
-                *node, STP_getState(), format::format("Cannot find function {0} in scope"s, { name }));
+            STP_throwError(*node, state, format::format("Cannot find function {0} in scope"s, { name }));
             return {};
         }
-        return parentScope->getFunction(node, name);
+        return parentScope->getFunction(node, name, state);
     }
 
     std::string STP_Scope::present() const
@@ -233,11 +321,88 @@ namespace steppable::parser
             ss << "(No variables are present.)" << "\n";
 
         for (const auto& [name, val] : variables)
-            ss << val.present(name) << "\n";
+            ss << val.presentMaterialized(name) << "\n";
 
         return ss.str();
     }
 
+    void STP_InterpStoreLocal::setLimits(const STP_Limits& newLimits)
+    {
+        limits = newLimits;
+        budgeted = limits.maxSteps != 0 or limits.timeoutMs != 0;
+    }
+
+    void STP_InterpStoreLocal::startEvaluation()
+    {
+        // Children of the previous evaluation keep its budget, and are not stopped by this one.
+        budget = std::make_shared<STP_Budget>();
+        stopFlag = std::make_shared<std::atomic<bool>>(false);
+        budget->deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(limits.timeoutMs);
+        limitHit = STP_LimitKind::NONE;
+    }
+
+    void STP_InterpStoreLocal::shareEvaluation(const STP_InterpStoreLocal& parent)
+    {
+        setLimits(parent.limits);
+        budget = parent.budget;
+        parentStopFlag = parent.stopFlag;
+        limitHit = STP_LimitKind::NONE;
+    }
+
+    void STP_InterpStoreLocal::checkBudget()
+    {
+        if (limitHit != STP_LimitKind::NONE)
+            return;
+
+        const std::uint64_t steps = budget->steps.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (limits.maxSteps != 0 and steps > limits.maxSteps)
+            hitLimit(STP_LimitKind::STEPS);
+        else if (limits.timeoutMs != 0 and std::chrono::steady_clock::now() >= budget->deadline)
+            hitLimit(STP_LimitKind::TIME);
+    }
+
+    bool STP_InterpStoreLocal::checkValueSize(const size_t elementBytes, const size_t count)
+    {
+        if (limits.maxValueBytes == 0 or count == 0 or elementBytes <= limits.maxValueBytes / count)
+            return true;
+
+        hitLimit(STP_LimitKind::VALUE_BYTES);
+        return false;
+    }
+
+    void STP_InterpStoreLocal::hitLimit(const STP_LimitKind kind)
+    {
+        if (limitHit != STP_LimitKind::NONE)
+            return;
+        limitHit = kind;
+        execState = STP_ExecState::REQUEST_STOP;
+
+        std::string message;
+        switch (kind)
+        {
+        case STP_LimitKind::STEPS:
+            message = format::format("Step limit of {0} exceeded"s, { std::to_string(limits.maxSteps) });
+            break;
+        case STP_LimitKind::TIME:
+            message = format::format("Time limit of {0} ms exceeded"s, { std::to_string(limits.timeoutMs) });
+            break;
+        case STP_LimitKind::VALUE_BYTES:
+            message = format::format("Value size limit of {0} bytes exceeded"s, {
+                std::to_string(limits.maxValueBytes),
+            });
+            break;
+        case STP_LimitKind::NONE:
+            return;
+        }
+
+        if (embedded)
+        {
+            setError(message);
+            return;
+        }
+        STP_reportError(output, message);
+    }
+
     STP_InterpStoreLocal::STP_InterpStoreLocal()
     {
         STP_DynamicLibrary stpFnLib("steppable");
@@ -246,24 +411,52 @@ namespace steppable::parser
 
     void STP_InterpStoreLocal::setChunk(const std::string& newChunk, const size_t& chunkStart, const size_t& chunkEnd)
     {
-        chunk = newChunk;
+        setChunk(std::make_shared<const STP_SourceBuffer>(newChunk));
         this->chunkStart = chunkStart;
         this->chunkEnd = chunkEnd;
     }
 
-    std::string STP_InterpStoreLocal::getChunk(const TSNode* node)
+    void STP_InterpStoreLocal::setChunk(std::shared_ptr<const STP_SourceBuffer> source)
+    {
+        chunk = std::make_shared<STP_ChunkContext>();
+        chunk->text = source->view();
+        chunk->source = std::move(source);
+        chunkStart = 0;
+        chunkEnd = chunk->text.size();
+    }
+
+    std::string STP_InterpStoreLocal::getChunk(const TSNode* node) { return std::string(getChunkView(node)); }
+
+    std::string_view STP_InterpStoreLocal::getChunkView(const TSNode* node) const
     {
         if (node == nullptr)
-            return chunk;
+            return chunk->text;
 
         uint32_t start = ts_node_start_byte(*node);
         uint32_t end = ts_node_end_byte(*node);
-        std::string text;
-        if (end - chunkStart <= chunk.size())
-            text = chunk.substr(start - chunkStart, end - start);
+        std::string_view text;
+        if (end - chunkStart <= chunk->text.size())
+            text = chunk->text.substr(start - chunkStart, end - start);
         return text;
     }
 
+    std::shared_ptr<const STP_StringTemplate> STP_InterpStoreLocal::findStringTemplate(const TSNode* node) const
+    {
+        std::lock_guard lock(chunk->stringTemplatesMutex);
+        if (const auto it = chunk->stringTemplates.find(node->id); it != chunk->stringTemplates.end())
+            return it->second;
+        return nullptr;
+    }
+
+    std::shared_ptr<const STP_StringTemplate> STP_InterpStoreLocal::addStringTemplate(
+        const TSNode* node, STP_StringTemplate&& stringTemplate)
+    {
+        auto stored = std::make_shared<const STP_StringTemplate>(std::move(stringTemplate));
+        std::lock_guard lock(chunk->stringTemplatesMutex);
+        chunk->stringTemplates.insert_or_assign(node->id, stored);
+        return stored;
+    }
+
     STP_Scope STP_InterpStoreLocal::addChildScope(STP_Scope* parent) const
     {
         STP_Scope scope;
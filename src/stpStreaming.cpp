@@ -0,0 +1,273 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include "stpInterp/stpStreaming.hpp"
+
+#include "output.hpp"
+#include "stpInterp/stpErrors.hpp"
+#include "stpInterp/stpIncrementalParse.hpp"
+#include "stpInterp/stpInterrupt.hpp"
+#include "stpInterp/stpProcessor.hpp"
+#include "stpInterp/stpSourceBuffer.hpp"
+
+#include <cerrno>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#if defined(_WIN32)
+    #include <io.h>
+#else
+    #include <poll.h>
+    #include <unistd.h>
+#endif
+
+using namespace std::literals;
+
+namespace steppable::parser
+{
+    namespace
+    {
+        /// How often waiting for input checks for an interrupt, in milliseconds.
+        constexpr int STREAM_POLL_INTERVAL_MS = 250;
+
+        /**
+         * @brief Read whatever is available from a stream, waiting only if nothing is.
+         *
+         * @param stream The stream to read from.
+         * @param buffer The buffer to read into.
+         * @return The number of bytes read. Zero at the end of the stream, on errors, or if interrupted.
+         */
+        size_t readAvailable(FILE* stream, std::vector<char>& buffer)
+        {
+            while (true)
+            {
+                if (STP_isInterruptRequested())
+                    return 0;
+#if defined(_WIN32)
+                const int bytesRead = _read(_fileno(stream), buffer.data(), static_cast<unsigned>(buffer.size()));
+#else
+                pollfd pollFd{ .fd = fileno(stream), .events = POLLIN, .revents = 0 };
+                const int ready = poll(&pollFd, 1, STREAM_POLL_INTERVAL_MS);
+                if (ready == 0 or (ready < 0 and errno == EINTR))
+                    continue;
+                const ssize_t bytesRead = read(fileno(stream), buffer.data(), buffer.size());
+#endif
+                if (bytesRead < 0 and errno == EINTR)
+                    continue;
+                return bytesRead > 0 ? static_cast<size_t>(bytesRead) : 0;
+            }
+        }
+
+        /**
+         * @brief Check whether a piece of source text ends inside a string or an unclosed bracket.
+         *
+         * @param text The source text to check.
+         * @return True if the text is incomplete. False otherwise.
+         */
+        bool hasOpenBrackets(const std::string_view text)
+        {
+            // '"' for strings, '\\' for formatting snippets in strings, and the opening brackets.
+            std::vector<char> open;
+            for (size_t i = 0; i < text.size(); i++)
+            {
+                const char c = text[i];
+                const char next = i + 1 < text.size() ? text[i + 1] : '\0';
+
+                if (not open.empty() and open.back() == '"')
+                {
+                    if (c == '\\' and next == '{')
+                        open.push_back('\\');
+                    if (c == '\\')
+                        i++;
+                    else if (c == '"')
+                        open.pop_back();
+                    continue;
+                }
+
+                switch (c)
+                {
+                case '\\':
+                    if (next == '}' and not open.empty() and open.back() == '\\')
+                    {
+                        open.pop_back();
+                        i++;
+                    }
+                    break;
+                case '#':
+                    i = text.find('\n', i);
+                    if (i == std::string_view::npos)
+                        return not open.empty();
+                    break;
+                case '"':
+                case '(':
+                case '[':
+                case '{':
+                    open.push_back(c);
+                    break;
+                case ')':
+                case ']':
+                case '}':
+                    if (not open.empty() and open.back() != '\\')
+                        open.pop_back();
+                    break;
+                default:
+                    break;
+                }
+            }
+            return not open.empty();
+        }
+
+        /**
+         * @brief Find the last complete top-level statement. Statements before it cannot be continued anymore, but it
+         * can, like an `if` whose `else` has not arrived yet.
+         *
+         * @param rootNode The root node of the source text.
+         * @return The index of the statement in the root node, or the number of children if there is none.
+         */
+        uint32_t findLastStatement(const TSNode rootNode)
+        {
+            const uint32_t childCount = ts_node_child_count(rootNode);
+            for (uint32_t i = childCount; i > 0; i--)
+            {
+                const TSNode child = ts_node_child(rootNode, i - 1);
+                if (ts_node_is_named(child) and not ts_node_has_error(child) and ts_node_type(child) != "comment"s)
+                    return i - 1;
+            }
+            return childCount;
+        }
+
+        /**
+         * @brief Execute all complete top-level statements at the start of the source text.
+         * @details The last statement is only executed at the end of the stream, as more text may still continue it.
+         *
+         * @param text Source text ending with a newline.
+         * @param atEnd Whether the stream has ended, so that incomplete statements are errors.
+         * @param state The current state of the interpreter.
+         * @param parser The parser, holding the tree of the text parsed last.
+         * @return The number of bytes executed, which can be dropped from the text.
+         */
+        size_t executeStatements(const std::string_view text,
+                                 const bool atEnd,
+                                 const STP_InterpState& state,
+                                 STP_IncrementalParser& parser)
+        {
+            const TSNode rootNode = ts_tree_root_node(parser.parse(text));
+            std::shared_ptr<const STP_SourceBuffer> source;
+
+            size_t executed = 0;
+            const uint32_t childCount = ts_node_child_count(rootNode);
+            const uint32_t lastStatement = findLastStatement(rootNode);
+            for (uint32_t i = 0; i < childCount and not state->shouldStop(); i++)
+            {
+                const TSNode child = ts_node_child(rootNode, i);
+                const bool complete = not ts_node_has_error(child) and not ts_node_is_missing(child);
+
+                // A statement that is still being written, like an unclosed loop body or a line ending in an
+                // operator, has nothing complete after it, or leaves a bracket open.
+                if (not atEnd and (i >= lastStatement or (not complete and hasOpenBrackets(text.substr(executed)))))
+                    break;
+
+                // Only copy the text when something is executed, as waiting for a long statement is common.
+                if (source == nullptr)
+                {
+                    source = std::make_shared<const STP_SourceBuffer>(std::string(text));
+                    state->setChunk(source);
+                }
+
+                if (not complete)
+                {
+                    STP_checkRecursiveNodeSanity(child, state);
+                    executed = text.size();
+                    break;
+                }
+
+                STP_processStatement(child, state);
+                if (state->getExecState() == STP_ExecState::RETURNED)
+                    state->setExecState(STP_ExecState::NORMAL);
+                executed = ts_node_end_byte(child);
+            }
+            return executed;
+        }
+    } // namespace
+
+    int STP_runStreaming(FILE* stream, const STP_InterpState& state, TSParser* parser)
+    {
+        // Errors stop the stream and are reported below, instead of exiting the process.
+        state->setEmbedded();
+
+        std::vector<char> block(STP_STREAM_BLOCK_SIZE);
+        std::string window;
+        STP_IncrementalParser incrementalParser(parser);
+        bool atEnd = false;
+
+        // The limits apply to the whole stream.
+        state->startEvaluation();
+        while (not atEnd and state->getExecState() != STP_ExecState::EXIT)
+        {
+            const size_t bytesRead = readAvailable(stream, block);
+            if (STP_isInterruptRequested())
+                return 1;
+            const std::string_view newText(block.data(), bytesRead);
+            window += newText;
+
+            // Statements end with a newline, so nothing can be executed until one arrives.
+            atEnd = bytesRead == 0;
+            if (atEnd and not window.empty() and window.back() != '\n')
+                window += '\n';
+            else if (not atEnd and newText.find('\n') == std::string_view::npos)
+                continue;
+
+            const size_t lastNewline = window.rfind('\n');
+            if (lastNewline == std::string::npos)
+                continue;
+
+            // While a statement is incomplete, the text only grows at its end, and the tree is parsed incrementally.
+            // Once statements are dropped from the front, what is left is parsed again.
+            const size_t executed =
+                executeStatements(std::string_view(window).substr(0, lastNewline + 1), atEnd, state, incrementalParser);
+            if (executed != 0)
+            {
+                window.erase(0, executed);
+                incrementalParser.reset();
+            }
+            state->getOutput().flush();
+
+            if (not state->getError().empty())
+            {
+                STP_reportError(state->getOutput(), state->getError());
+                return 1;
+            }
+            if (state->getExecState() == STP_ExecState::REQUEST_STOP)
+                return 1;
+
+            if (window.size() > STP_STREAM_WINDOW_LIMIT)
+            {
+                output::error("parser"s,
+                              "Incomplete statement is longer than {0} bytes"s,
+                              { std::to_string(STP_STREAM_WINDOW_LIMIT) });
+                return 1;
+            }
+        }
+        return 0;
+    }
+} // namespace steppable::parser
@@ -0,0 +1,135 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include "stpInterp/stpThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace steppable::parser
+{
+    STP_ThreadPool::STP_ThreadPool(size_t threadCount)
+    {
+        if (threadCount == 0)
+            threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+        workers.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; i++)
+            workers.emplace_back([this] { workerLoop(); });
+    }
+
+    STP_ThreadPool::~STP_ThreadPool()
+    {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        taskAvailable.notify_all();
+        for (auto& worker : workers)
+            if (worker.joinable())
+                worker.join();
+    }
+
+    void STP_ThreadPool::submit(std::function<void()> task)
+    {
+        {
+            std::lock_guard lock(mutex);
+            tasks.emplace(std::move(task));
+        }
+        taskAvailable.notify_one();
+    }
+
+    void STP_ThreadPool::parallelFor(const size_t begin,
+                                     const size_t end,
+                                     size_t grain,
+                                     const std::function<void(size_t chunkBegin, size_t chunkEnd)>& fn)
+    {
+        if (begin >= end)
+            return;
+        grain = std::max<size_t>(grain, 1);
+
+        const size_t chunkCount = (end - begin + grain - 1) / grain;
+        if (chunkCount == 1)
+        {
+            fn(begin, end);
+            return;
+        }
+
+        // Helpers may start after this call returns, so everything they use is kept in a shared block.
+        struct Shared
+        {
+            std::atomic<size_t> nextChunk = 0;
+            std::atomic<size_t> doneChunks = 0;
+            std::mutex mutex;
+            std::condition_variable done;
+        };
+        auto shared = std::make_shared<Shared>();
+        const auto* fnPtr = &fn;
+
+        const auto runChunks = [shared, fnPtr, begin, end, grain, chunkCount] {
+            size_t chunk = 0;
+            while ((chunk = shared->nextChunk.fetch_add(1)) < chunkCount)
+            {
+                const size_t chunkBegin = begin + (chunk * grain);
+                (*fnPtr)(chunkBegin, std::min(end, chunkBegin + grain));
+                if (shared->doneChunks.fetch_add(1) + 1 == chunkCount)
+                {
+                    std::lock_guard lock(shared->mutex);
+                    shared->done.notify_all();
+                }
+            }
+        };
+
+        const size_t helpers = std::min(workers.size(), chunkCount - 1);
+        for (size_t i = 0; i < helpers; i++)
+            submit(runChunks);
+        runChunks();
+
+        // `fn` is only called for chunks taken before all of them are done, so it outlives every call.
+        std::unique_lock lock(shared->mutex);
+        shared->done.wait(lock, [&] { return shared->doneChunks.load() == chunkCount; });
+    }
+
+    STP_ThreadPool& STP_ThreadPool::shared()
+    {
+        static STP_ThreadPool pool;
+        return pool;
+    }
+
+    void STP_ThreadPool::workerLoop()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(mutex);
+                taskAvailable.wait(lock, [this] { return stopping or not tasks.empty(); });
+                if (stopping and tasks.empty())
+                    return;
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+        }
+    }
+} // namespace steppable::parser
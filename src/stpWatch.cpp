@@ -0,0 +1,479 @@
+/**************************************************************************************************
+ * Copyright (c) 2023-2025 NWSOFT                                                                 *
+ *                                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy                   *
+ * of this software and associated documentation files (the "Software"), to deal                  *
+ * in the Software without restriction, including without limitation the rights                   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                      *
+ * copies of the Software, and to permit persons to whom the Software is                          *
+ * furnished to do so, subject to the following conditions:                                       *
+ *                                                                                                *
+ * The above copyright notice and this permission notice shall be included in all                 *
+ * copies or substantial portions of the Software.                                                *
+ *                                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE                    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,                  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE                  *
+ * SOFTWARE.                                                                                      *
+ **************************************************************************************************/
+
+#include "stpInterp/stpWatch.hpp"
+
+#include "output.hpp"
+#include "stpInterp/stpBetterTS.hpp"
+#include "stpInterp/stpErrors.hpp"
+#include "stpInterp/stpIncrementalParse.hpp"
+#include "stpInterp/stpInterrupt.hpp"
+#include "stpInterp/stpProcessor.hpp"
+#include "stpInterp/stpSourceBuffer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#if defined(__linux__)
+    #include <poll.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+using namespace std::literals;
+
+namespace steppable::parser
+{
+    namespace
+    {
+        /**
+         * @struct ScopeCheckpoint
+         * @brief A copy of the global scope, taken before the first top-level statement.
+         */
+        struct ScopeCheckpoint
+        {
+            STP_StringValMap variables; ///< Variables of the global scope.
+            std::map<std::string, STP_FunctionDefinition> functions; ///< Functions of the global scope.
+        };
+
+        /**
+         * @struct NameValues
+         * @brief Values of some names of the global scope. Names without a value did not exist.
+         */
+        struct NameValues
+        {
+            std::map<std::string, std::optional<STP_Value>> variables; ///< Variables with the names.
+            std::map<std::string, std::optional<STP_FunctionDefinition>> functions; ///< Functions with the names.
+        };
+
+        /**
+         * @struct WatchRun
+         * @brief The top-level statements of the last executed version of the file, and what each of them assigned.
+         * @details Only the names that each statement assigns are kept, rather than the whole scope after it, so that
+         * the memory used grows with the assignments instead of with statements times the size of the scope.
+         */
+        struct WatchRun
+        {
+            std::vector<std::string> keys; ///< Text of each statement, with the number of earlier identical ones.
+            std::vector<std::set<std::string>> writes; ///< Names assigned by each statement.
+
+            std::optional<ScopeCheckpoint> initial; ///< Global scope before the first statement ever executed.
+
+            /// Values of the names assigned by each statement that completed, right after it. Statement `i` completed
+            /// if `i < results.size()`.
+            std::vector<NameValues> results;
+        };
+
+        /**
+         * @brief Get the current values of some names of the global scope.
+         *
+         * @param names The names, which may be variables or functions.
+         * @param state The current state of the interpreter.
+         * @return The values of the names.
+         */
+        NameValues captureNames(const std::set<std::string>& names, const STP_InterpState& state)
+        {
+            const STP_Scope* globalScope = state->getGlobalScope();
+            NameValues values;
+            for (const std::string& name : names)
+            {
+                auto& variable = values.variables[name];
+                if (const auto it = globalScope->variables.find(name); it != globalScope->variables.end())
+                    variable = it->second;
+                auto& function = values.functions[name];
+                if (const auto it = globalScope->functions.find(name); it != globalScope->functions.end())
+                    function = it->second;
+            }
+            return values;
+        }
+
+        /**
+         * @brief Set names of the global scope to some values. Names without a value are removed.
+         *
+         * @param values The values of the names.
+         * @param state The current state of the interpreter.
+         */
+        void restoreNames(const NameValues& values, const STP_InterpState& state)
+        {
+            STP_Scope* globalScope = state->getGlobalScope();
+            for (const auto& [name, value] : values.variables)
+            {
+                if (value)
+                    globalScope->variables.insert_or_assign(name, *value);
+                else
+                    globalScope->variables.erase(name);
+            }
+            for (const auto& [name, function] : values.functions)
+            {
+                if (function)
+                    globalScope->functions.insert_or_assign(name, *function);
+                else
+                    globalScope->functions.erase(name);
+            }
+        }
+
+        /**
+         * @brief Bring the global scope back to how it was before a statement of the last executed version.
+         * @details Only the names assigned by that statement and the ones after it are changed. Each gets the value
+         * assigned by the last statement before it, or its initial value.
+         *
+         * @param run The last executed version of the file.
+         * @param first The index of the statement.
+         * @param state The current state of the interpreter.
+         */
+        void rewindTo(const WatchRun& run, const size_t first, const STP_InterpState& state)
+        {
+            // Statements that did not complete may have assigned some of their names too.
+            std::set<std::string> names;
+            for (size_t j = first; j < run.writes.size(); j++)
+                names.insert(run.writes[j].begin(), run.writes[j].end());
+
+            NameValues values;
+            for (const std::string& name : names)
+            {
+                auto& variable = values.variables[name];
+                auto& function = values.functions[name];
+                if (const auto it = run.initial->variables.find(name); it != run.initial->variables.end())
+                    variable = it->second;
+                if (const auto it = run.initial->functions.find(name); it != run.initial->functions.end())
+                    function = it->second;
+
+                for (size_t j = first; j > 0; j--)
+                {
+                    if (not run.writes[j - 1].contains(name))
+                        continue;
+                    variable = run.results[j - 1].variables.at(name);
+                    function = run.results[j - 1].functions.at(name);
+                    break;
+                }
+            }
+            restoreNames(values, state);
+        }
+
+        /**
+         * @brief Add the names read by the functions that a statement calls, and by the functions that they call.
+         * @details Function bodies read globals that are not visible in the statement itself, so a statement is
+         * affected by a change to any of them.
+         *
+         * @param reads The names read by the statement. Names read by the functions are added to it.
+         * @param functionReads The names read by the definition of each function in the file.
+         */
+        void addFunctionReads(std::set<std::string>& reads,
+                              const std::unordered_map<std::string, std::set<std::string>>& functionReads)
+        {
+            std::vector<std::string> pending(reads.begin(), reads.end());
+            while (not pending.empty())
+            {
+                const auto it = functionReads.find(pending.back());
+                pending.pop_back();
+                if (it == functionReads.end())
+                    continue;
+                for (const std::string& name : it->second)
+                    if (reads.insert(name).second)
+                        pending.push_back(name);
+            }
+        }
+
+        /**
+         * @brief Collect the names that a statement uses and the names that it assigns.
+         *
+         * @param node The statement node.
+         * @param state The current state of the interpreter.
+         * @param reads The names used by the statement, including the ones it assigns.
+         * @param writes The names assigned by the statement.
+         */
+        void collectNames(const TSNode& node,
+                          const STP_InterpState& state,
+                          std::set<std::string>& reads,
+                          std::set<std::string>& writes)
+        {
+            const std::string_view type = ts_node_type(node);
+            if (type == "identifier")
+                reads.emplace(state->getChunkView(&node));
+
+            std::string writeField;
+            if (type == "assignment")
+                writeField = "name";
+            else if (type == "function_definition")
+                writeField = "fn_name";
+            else if (type == "symbol_decl_statement")
+                writeField = "sym_name";
+            else if (type == "for_in_stmt")
+                writeField = "loop_var";
+            if (not writeField.empty())
+            {
+                const TSNode nameNode = ts_node_child_by_field_name(node, writeField);
+                if (not ts_node_is_null(nameNode))
+                    writes.emplace(state->getChunkView(&nameNode));
+            }
+
+            for (uint32_t i = 0; i < ts_node_child_count(node); i++)
+                collectNames(ts_node_child(node, i), state, reads, writes);
+        }
+
+        /**
+         * @brief Read a whole file. The file is copied rather than mapped, as it may be rewritten while it is used.
+         *
+         * @param path Path to the file.
+         * @return The contents of the file, or nothing if it cannot be opened.
+         */
+        std::optional<std::string> readFile(const std::string& path)
+        {
+            std::ifstream file(path, std::ios::in | std::ios::binary);
+            if (not file)
+                return std::nullopt;
+            return std::string(std::istreambuf_iterator(file), std::istreambuf_iterator<char>());
+        }
+
+        /**
+         * @brief Execute the statements of a new version of the file that are affected by the change.
+         *
+         * @param text The new contents of the file.
+         * @param incrementalParser The parser holding the tree of the previous version.
+         * @param run The last executed version of the file. Updated to this version.
+         * @param state The current state of the interpreter.
+         */
+        void executeChanged(std::string text,
+                            STP_IncrementalParser& incrementalParser,
+                            WatchRun& run,
+                            const STP_InterpState& state)
+        {
+            const auto source = std::make_shared<const STP_SourceBuffer>(std::move(text));
+            const TSTree* tree = incrementalParser.parse(source->view());
+            if (incrementalParser.getChangedRanges().empty())
+                return;
+
+            const TSNode rootNode = ts_tree_root_node(tree);
+            state->setChunk(source);
+            if (STP_checkRecursiveNodeSanity(rootNode, state))
+            {
+                // Compare the next version with the last executed one, as nothing has been executed since.
+                incrementalParser.reset();
+                return;
+            }
+
+            WatchRun current;
+            std::vector<TSNode> statements;
+            std::vector<std::set<std::string>> statementReads;
+            std::unordered_map<std::string, std::set<std::string>> functionReads;
+            std::unordered_map<std::string, size_t> occurrences;
+            for (uint32_t i = 0; i < ts_node_child_count(rootNode); i++)
+            {
+                const TSNode child = ts_node_child(rootNode, i);
+                if (not ts_node_is_named(child) or ts_node_type(child) == "comment"s)
+                    continue;
+
+                std::set<std::string> reads;
+                std::set<std::string> writes;
+                collectNames(child, state, reads, writes);
+                if (ts_node_type(child) == "function_definition"s)
+                    for (const std::string& name : writes)
+                        functionReads.insert_or_assign(name, reads);
+
+                // Identical statements are told apart by their order.
+                const std::string statementText = state->getChunk(&child);
+                current.keys.push_back(statementText + '\0' + std::to_string(occurrences[statementText]++));
+                current.writes.push_back(std::move(writes));
+                statements.push_back(child);
+                statementReads.push_back(std::move(reads));
+            }
+            for (auto& reads : statementReads)
+                addFunctionReads(reads, functionReads);
+
+            // Statements before the first changed one are unchanged, and so is the scope before that statement.
+            const size_t completedCount = run.results.size();
+            size_t first = 0;
+            while (first < statements.size() and first < completedCount and current.keys[first] == run.keys[first])
+                first++;
+
+            // Later statements of the previous version that completed, and whose values can be reused.
+            std::unordered_map<std::string, size_t> previousIndices;
+            for (size_t j = first; j < completedCount; j++)
+                previousIndices.emplace(run.keys[j], j);
+
+            // Names assigned by removed statements may now have different values.
+            std::set<std::string> changedNames;
+            const std::set<std::string> currentKeys(current.keys.begin(), current.keys.end());
+            for (size_t j = first; j < run.keys.size(); j++)
+                if (not currentKeys.contains(run.keys[j]))
+                    changedNames.insert(run.writes[j].begin(), run.writes[j].end());
+
+            // Start from the scope before the first changed statement, so that it runs with the values it saw.
+            if (run.initial)
+                rewindTo(run, first, state);
+            else
+            {
+                const STP_Scope* globalScope = state->getGlobalScope();
+                run.initial = ScopeCheckpoint{ .variables = globalScope->variables,
+                                               .functions = globalScope->functions };
+            }
+            current.initial = std::move(run.initial);
+            current.results.assign(std::make_move_iterator(run.results.begin()),
+                                   std::make_move_iterator(run.results.begin() + static_cast<std::ptrdiff_t>(first)));
+            state->setCurrentScope(state->getGlobalScope());
+
+            size_t executedCount = 0;
+            state->startEvaluation();
+            for (size_t i = first; i < statements.size() and not state->shouldStop(); i++)
+            {
+                const auto previous = previousIndices.find(current.keys[i]);
+                const bool readsChanged = std::ranges::any_of(
+                    statementReads[i], [&](const std::string& name) { return changedNames.contains(name); });
+                if (i != first and previous != previousIndices.end() and not readsChanged)
+                {
+                    // The statement would assign the same values as before.
+                    restoreNames(run.results[previous->second], state);
+                    current.results.push_back(std::move(run.results[previous->second]));
+                    continue;
+                }
+
+                STP_processStatement(statements[i], state);
+                if (state->getExecState() == STP_ExecState::RETURNED)
+                    state->setExecState(STP_ExecState::NORMAL);
+                changedNames.insert(current.writes[i].begin(), current.writes[i].end());
+                executedCount++;
+                if (not state->shouldStop())
+                    current.results.push_back(captureNames(current.writes[i], state));
+            }
+            run = std::move(current);
+
+            state->getOutput().flush();
+            output::info("parser"s,
+                         "Executed {0} of {1} statements"s,
+                         { std::to_string(executedCount), std::to_string(statements.size()) });
+        }
+
+        /**
+         * @brief Wait until the file is written to, created or replaced.
+         *
+         * @param path Path to the file.
+         * @param notifyFd An inotify descriptor watching the directory of the file, or -1 to poll instead.
+         * @return True if the file changed. False if waiting failed or is interrupted.
+         */
+        bool waitForChange(const std::filesystem::path& path, [[maybe_unused]] const int notifyFd)
+        {
+#if defined(__linux__)
+            if (notifyFd >= 0)
+            {
+                alignas(inotify_event) std::array<char, 4096> buffer{};
+                while (true)
+                {
+                    pollfd pollFd{ .fd = notifyFd, .events = POLLIN, .revents = 0 };
+                    if (poll(&pollFd, 1, STP_WATCH_POLL_INTERVAL_MS) <= 0)
+                    {
+                        if (STP_isInterruptRequested())
+                            return false;
+                        continue;
+                    }
+
+                    const ssize_t length = read(notifyFd, buffer.data(), buffer.size());
+                    if (length <= 0)
+                        return false;
+                    for (ssize_t offset = 0; offset < length;)
+                    {
+                        const auto* event = reinterpret_cast<const inotify_event*>( // NOLINT(*-reinterpret-cast)
+                            buffer.data() + offset);
+                        if (event->len != 0 and event->name == path.filename().string())
+                            return true;
+                        offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+                    }
+                }
+            }
+#endif
+            std::error_code error;
+            const auto lastWriteTime = std::filesystem::last_write_time(path, error);
+            while (true)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(STP_WATCH_POLL_INTERVAL_MS));
+                if (STP_isInterruptRequested())
+                    return false;
+                if (std::filesystem::last_write_time(path, error) != lastWriteTime)
+                    return true;
+            }
+        }
+    } // namespace
+
+    int STP_runWatch(const std::string& path, const STP_InterpState& state, TSParser* parser)
+    {
+        // Keep watching when the program has errors.
+        state->setInteractive();
+
+        int notifyFd = -1;
+#if defined(__linux__)
+        notifyFd = inotify_init1(IN_CLOEXEC);
+        if (notifyFd >= 0)
+        {
+            std::filesystem::path directory = std::filesystem::path(path).parent_path();
+            if (directory.empty())
+                directory = ".";
+            // Editors often replace the file instead of writing to it, so watch the directory.
+            if (inotify_add_watch(notifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0)
+            {
+                close(notifyFd);
+                notifyFd = -1;
+            }
+        }
+#endif
+
+        STP_IncrementalParser incrementalParser(parser);
+        WatchRun run;
+        int ret = 0;
+        while (state->getExecState() != STP_ExecState::EXIT)
+        {
+            if (auto text = readFile(path))
+                executeChanged(std::move(*text), incrementalParser, run, state);
+            else
+                output::error("parser"s, "Unable to open file {0}"s, { path });
+
+            if (state->getExecState() == STP_ExecState::EXIT)
+                break;
+            state->setExecState(STP_ExecState::NORMAL);
+
+            // [Ctrl-C] during a run only stops the run. While waiting, it stops watching.
+            STP_clearInterrupt();
+            if (not waitForChange(path, notifyFd))
+            {
+                ret = STP_isInterruptRequested() ? 0 : 1;
+                break;
+            }
+        }
+
+#if defined(__linux__)
+        if (notifyFd >= 0)
+            close(notifyFd);
+#endif
+        return ret;
+    }
+} // namespace steppable::parser